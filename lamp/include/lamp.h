@@ -98,6 +98,11 @@ __lamp_i16   __lamp_any_range_i16(__lamp_i16 from, __lamp_i16 to);
 __lamp_i32   __lamp_any_range_i32(__lamp_i32 from, __lamp_i32 to);
 __lamp_i64   __lamp_any_range_i64(__lamp_i64 from, __lamp_i64 to);
 
+__lamp_i8    __lamp_any_varg_i8(int count, ...);
+__lamp_i16   __lamp_any_varg_i16(int count, ...);
+__lamp_i32   __lamp_any_varg_i32(int count, ...);
+__lamp_i64   __lamp_any_varg_i64(int count, ...);
+
 float    __lamp_any_f32  ( void );
 double   __lamp_any_f64  ( void );
 void    *__lamp_any_ptr  ( void );
@@ -0,0 +1,66 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+namespace __lamp
+{
+    /* Bump allocator for abstract values that live until the end of the
+     * program, such as nodes of the operation history. Memory is allocated
+     * in large chunks and never returned. */
+    struct arena
+    {
+        static constexpr std::size_t chunk_size = 1 << 20;
+
+        void *allocate( std::size_t size, std::size_t align )
+        {
+            auto ptr = aligned( _next, align );
+            if ( ptr + size > _end ) {
+                refill( size + align );
+                ptr = aligned( _next, align );
+            }
+            _next = ptr + size;
+            return reinterpret_cast< void * >( ptr );
+        }
+
+        static arena &global() { return _global; }
+
+    private:
+        static uintptr_t aligned( uintptr_t ptr, std::size_t align )
+        {
+            return ( ptr + align - 1 ) & ~( align - 1 );
+        }
+
+        void refill( std::size_t size )
+        {
+            auto bytes = std::max( chunk_size, size );
+            _next = reinterpret_cast< uintptr_t >( std::malloc( bytes ) );
+            _end = _next + bytes;
+        }
+
+        uintptr_t _next = 0, _end = 0;
+
+        static arena _global;
+    };
+
+    inline arena arena::_global;
+
+} // namespace __lamp
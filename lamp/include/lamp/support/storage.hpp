@@ -20,8 +20,11 @@
 #include <cstdint>
 #include <memory>
 #include <limits>
+#include <new>
+#include <utility>
 
 #include <lava/support/base.hpp> /* domain_ref, construct_shared */
+#include <lamp/support/arena.hpp>
 
 namespace __lamp
 {
@@ -109,9 +112,56 @@ namespace __lamp
         std::unique_ptr< storage > _storage;
     };
 
+    /* Owning pointer to storage allocated in the global arena, the value is
+     * destroyed unless disowned, but the memory is never reclaimed. */
+    template< typename storage >
+    struct arena_pointer
+    {
+        using value_type = typename storage::value_type;
+
+        template< typename ...args >
+        arena_pointer( args &&...a )
+            : _storage( new ( allocate() ) storage( std::forward< args >(a)... ) )
+        {}
+
+        arena_pointer( void *ptr, construct_shared_t )
+            : _storage( static_cast< storage* >( ptr ) )
+        {}
+
+        arena_pointer( const arena_pointer & ) = delete;
+        arena_pointer( arena_pointer &&o ) : _storage( o._storage ) { o._storage = nullptr; }
+
+        ~arena_pointer()
+        {
+            if ( _storage )
+                _storage->~storage();
+        }
+
+        const value_type &get() const { return _storage->value(); }
+        value_type       &get()       { return _storage->value(); }
+
+        const storage &store() const { return *_storage; }
+        storage       &store()       { return *_storage; }
+
+        const value_type *operator->() const { return &get(); }
+        value_type       *operator->()       { return &get(); }
+
+        void *unsafe_ptr() const { return _storage; }
+
+        void *disown() { return std::exchange( _storage, nullptr ); }
+
+    private:
+        static void *allocate() { return arena::global().allocate( sizeof( storage ), alignof( storage ) ); }
+
+        storage *_storage;
+    };
+
     template< typename data >
     using wrapped_storage = pointer< storage< wrapped< data > > >;
 
+    template< typename data >
+    using arena_storage = arena_pointer< storage< wrapped< data > > >;
+
     template< typename data >
     using tagged_storage = pointer< storage< tagged< data > > >;
 
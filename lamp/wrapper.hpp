@@ -25,9 +25,12 @@
 #include <lava/constant.hpp>
 
 #include <runtime/lart.h>
+#include <runtime/config.hpp>
 #include <runtime/shadow.hpp>
 
+#include <map>
 #include <string>
+#include <tuple>
 
 typedef struct { void *ptr; } __lamp_ptr;
 
@@ -132,6 +135,15 @@ namespace lamp::detail
     void freeze( __lamp_ptr val, void *addr, size_t bytes );
 
     __lamp_ptr melt( void *addr, size_t bytes );
+
+    void widen_enter( uint32_t site );
+
+    template< typename type, typename lift_t >
+    type widen( type *addr, uint32_t site, lift_t lift );
+
+    void widen_stable( uint32_t site );
+
+    void widen_reset( uint32_t site );
 }
 
 extern "C"
@@ -207,7 +219,6 @@ extern "C"
         va_list args;
         va_start(args, count);
         auto res = any< dom, i32 >(variadic_list(count, args));
-        fprintf(stderr, "here\n");
         va_end(args);
         return res;
     }
@@ -244,6 +255,15 @@ extern "C"
     __lamp_ptr __lamp_join( __lamp_ptr a, __lamp_ptr b ) { return wrap( dom::op_join, a, b ); }
     __lamp_ptr __lamp_meet( __lamp_ptr a, __lamp_ptr b ) { return wrap( dom::op_meet, a, b ); }
 
+    i8  __lamp_widen_i8 ( i8  *addr, uint32_t site ) { return lamp::detail::widen( addr, site, dom::lift_i8 ); }
+    i16 __lamp_widen_i16( i16 *addr, uint32_t site ) { return lamp::detail::widen( addr, site, dom::lift_i16 ); }
+    i32 __lamp_widen_i32( i32 *addr, uint32_t site ) { return lamp::detail::widen( addr, site, dom::lift_i32 ); }
+    i64 __lamp_widen_i64( i64 *addr, uint32_t site ) { return lamp::detail::widen( addr, site, dom::lift_i64 ); }
+
+    void __lamp_widen_enter( uint32_t site ) { lamp::detail::widen_enter( site ); }
+    void __lamp_widen_stable( uint32_t site ) { lamp::detail::widen_stable( site ); }
+    void __lamp_widen_reset( uint32_t site ) { lamp::detail::widen_reset( site ); }
+
     __lamp_ptr __lamp_add ( __lamp_ptr a, __lamp_ptr b ) { return wrap( dom::op_add, a, b ); }
     __lamp_ptr __lamp_sub ( __lamp_ptr a, __lamp_ptr b ) { return wrap( dom::op_sub, a, b ); }
     __lamp_ptr __lamp_mul ( __lamp_ptr a, __lamp_ptr b ) { return wrap( dom::op_mul, a, b ); }
@@ -415,4 +435,104 @@ namespace lamp::detail
 
         return result;
     }
+
+    /* Loop-carried values seen at loop headers, keyed by the frame of the
+     * loop, the header and their location, so that recursive activations of
+     * the loop do not share the state. The state is per path, forks inherit
+     * a copy of it. */
+    struct widening_state
+    {
+        __lamp_ptr last = { nullptr }; /* value from the previous visit */
+    };
+
+    /* Visits of a loop header and whether every value widened in the current
+     * visit is subsumed by its value from the previous one. */
+    struct loop_state
+    {
+        unsigned visits = 0;
+        bool stable = false;
+    };
+
+    using loop_key = std::tuple< size_t, uint32_t >;
+    using widening_key = std::tuple< size_t, uint32_t, void * >;
+
+    static std::map< loop_key, loop_state > loops;
+    static std::map< widening_key, widening_state > widenings;
+
+    /* Destroys a value that is no longer referenced by the program. */
+    static void release( __lamp_ptr value )
+    {
+        if ( value.ptr ) {
+            dom owner( value.ptr, __lava::construct_shared );
+        }
+    }
+
+    static void erase_widenings( std::map< widening_key, widening_state >::iterator from,
+                                 std::map< widening_key, widening_state >::iterator to )
+    {
+        for ( auto it = from; it != to; ++it )
+            release( it->second.last );
+        widenings.erase( from, to );
+    }
+
+    /* Widenings of loops in the destroyed frame (and deeper) are stale. */
+    static void exit_frame_widenings( size_t depth )
+    {
+        loops.erase( loops.lower_bound( { depth, 0 } ), loops.end() );
+        erase_widenings( widenings.lower_bound( { depth, 0, nullptr } ), widenings.end() );
+    }
+
+    void widen_reset( uint32_t site )
+    {
+        auto depth = __lart::rt::frame_depth();
+        loops.erase( loop_key{ depth, site } );
+        erase_widenings( widenings.lower_bound( { depth, site, nullptr } ),
+                         widenings.lower_bound( { depth, site + 1, nullptr } ) );
+    }
+
+    void widen_enter( uint32_t site )
+    {
+        __lart::rt::frame_exit_hook = exit_frame_widenings;
+        auto &loop = loops[ { __lart::rt::frame_depth(), site } ];
+        loop.stable = ++loop.visits > __lart::rt::config->widen_after;
+    }
+
+    /* After `widen_after` visits of the header the value is widened by the
+     * previous one. The loop is stable only if every value widened in this
+     * visit is subsumed by the previous one. */
+    template< typename type, typename lift_t >
+    type widen( type *addr, uint32_t site, lift_t lift )
+    {
+        auto depth = __lart::rt::frame_depth();
+        auto &loop = loops[ { depth, site } ];
+        auto &state = widenings[ { depth, site, addr } ];
+
+        auto next = __lart_test_taint( addr, sizeof( type ) )
+                  ? __lamp_copy( melt( addr, sizeof( type ) ) )
+                  : wrap( lift, *addr );
+
+        if ( loop.visits > __lart::rt::config->widen_after && state.last.ptr ) {
+            loop.stable = loop.stable && dom::subsumes( ref( state.last.ptr ), ref( next.ptr ) );
+            auto widened = wrap( dom::op_widen, state.last, next );
+            release( next );
+            next = widened;
+        } else {
+            loop.stable = false;
+        }
+
+        release( state.last );
+        state.last = __lamp_copy( next );
+        __lart_stash( true, next.ptr );
+        return *addr;
+    }
+
+    /* Emitted only for loops whose whole carried state is widened. Once the
+     * previous visit subsumes all of it, the loop has already been explored
+     * from a larger state and the path is cancelled. */
+    void widen_stable( uint32_t site )
+    {
+        if ( loops[ { __lart::rt::frame_depth(), site } ].stable )
+            __lart_cancel();
+    }
+
 } // namespace lamp::detail
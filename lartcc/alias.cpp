@@ -15,8 +15,82 @@
  */
 
 #include <cc/alias.hpp>
+#include <cc/stats.hpp>
+
+#include <svf/SVF-FE/SVFIRBuilder.h>
+#include <svf/SVF-FE/LLVMModule.h>
+#include <svf/WPA/Steensgaard.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <string>
+#include <string_view>
 
 namespace lart::aa
 {
+    // peak resident set size in KiB
+    static long peak_memory()
+    {
+        rusage usage;
+        getrusage( RUSAGE_SELF, &usage );
+        return usage.ru_maxrss;
+    }
+
+    template< typename fn_t >
+    static auto measure( std::string_view what, fn_t &&fn )
+    {
+        auto phase = statistics::get().phase( "svf " + std::string( what ) );
+        auto start = std::chrono::steady_clock::now();
+        auto memory = peak_memory();
+
+        auto result = fn();
+
+        auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >(
+            std::chrono::steady_clock::now() - start
+        );
+        spdlog::info( "[aa] {} took {} ms, peak memory grew by {} KiB",
+            what, elapsed.count(), peak_memory() - memory );
+        return result;
+    }
+
+    static std::string_view name( alias_kind kind )
+    {
+        switch ( kind ) {
+            case alias_kind::andersen:    return "andersen";
+            case alias_kind::steensgaard: return "steensgaard";
+        }
+        llvm_unreachable( "unknown alias analysis" );
+    }
+
+    void alias_analysis::init()
+    {
+        pta = measure( name( kind ), [&] () -> SVF::BVDataPTAImpl * {
+            spdlog::debug( "[aa] setup svf module" );
+            auto svfmodule = SVF::LLVMModuleSet::getLLVMModuleSet()->buildSVFModule( module );
+            svfmodule->buildSymbolTableInfo();
+            assert( svfmodule != nullptr && "SVF Module is null" );
+
+            SVF::SVFIRBuilder builder;
+            auto svfir = builder.build( svfmodule );
+            assert( svfir != nullptr && "SVFIR is null" );
+
+            switch ( kind ) {
+                case alias_kind::andersen:
+                    return SVF::AndersenWaveDiff::createAndersenWaveDiff( svfir );
+                case alias_kind::steensgaard:
+                    return SVF::Steensgaard::createSteensgaard( svfir );
+            }
+            llvm_unreachable( "unknown alias analysis" );
+        } );
+    }
+
+    void alias_analysis::build_value_flow()
+    {
+        value_flow = measure( "value-flow graph", [&] {
+            SVF::SVFGBuilder value_flow_builder(true);
+            return std::unique_ptr< SVF::SVFG >( value_flow_builder.buildFullSVFG( analysis() ) );
+        } );
+    }
 
 } // namespace lart::aa
@@ -19,6 +19,8 @@
 
 #include <sc/builder.hpp>
 
+#include <llvm/IR/MDBuilder.h>
+
 #include <cassert>
 
 namespace lart::backend
@@ -173,6 +175,16 @@ namespace lart::backend
                 bld = std::move(bld) | sc::action::ret();
             }
         }
+
+        // The test is inlined to call sites so that concrete operands cost
+        // only the taint check, the abstract path with the out-of-line
+        // lifter call is expected to be rare.
+        auto br = llvm::cast< llvm::BranchInst >( fn->getEntryBlock().getTerminator() );
+        auto weights = llvm::MDBuilder( fn->getContext() ).createBranchWeights( 1, 2000 );
+        br->setMetadata( llvm::LLVMContext::MD_prof, weights );
+
+        fn->setLinkage( llvm::GlobalValue::InternalLinkage );
+        fn->addFnAttr( llvm::Attribute::AlwaysInline );
     }
 
     void native::lower( callinst call, op::freeze )
@@ -0,0 +1,277 @@
+/*
+ * (c) 2020, 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cc/cache.hpp>
+
+#include <cc/logger.hpp>
+#include <cc/options.hpp>
+#include <cc/preprocess.hpp>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lart
+{
+    namespace
+    {
+        // bump whenever the analysis or the format of entries changes
+        constexpr unsigned version = 1;
+
+        std::string name( alias_kind kind )
+        {
+            return kind == alias_kind::andersen ? "andersen" : "steensgaard";
+        }
+
+        std::string module_hash( llvm::Module &m )
+        {
+            std::string text;
+            llvm::raw_string_ostream os( text );
+            os << "lartcc " << version << " " << name( options::get().alias ) << "\n";
+            m.print( os, nullptr );
+            os.flush();
+
+            return llvm::toHex( llvm::SHA1::hash( llvm::arrayRefFromStringRef( text ) ), true );
+        }
+
+        bool is_preprocessed( const llvm::Function &fn )
+        {
+            return fn.getMetadata( preprocessor::tag );
+        }
+
+        /* A value is written as a kind followed by its position: a function
+         * (`f fn`), a global variable (`g idx`), an argument (`a fn idx`), an
+         * instruction (`i fn idx`) or a constant expression as an operand of
+         * an instruction (`c fn idx operand`). */
+        struct numbering
+        {
+            explicit numbering( llvm::Module &m )
+            {
+                for ( auto &fn : m ) {
+                    function_index[ &fn ] = functions.size();
+                    functions.push_back( &fn );
+
+                    auto &insts = instructions.emplace_back();
+                    for ( auto &inst : llvm::instructions( fn ) ) {
+                        instruction_index[ &inst ] = insts.size();
+                        insts.push_back( &inst );
+                    }
+                }
+
+                for ( auto &glob : m.globals() ) {
+                    global_index[ &glob ] = globals.size();
+                    globals.push_back( &glob );
+                }
+            }
+
+            std::string instruction( llvm::Instruction *inst ) const
+            {
+                auto fn = function_index.at( inst->getFunction() );
+                return std::to_string( fn ) + " " + std::to_string( instruction_index.at( inst ) );
+            }
+
+            std::optional< std::string > position( llvm::Value *val ) const
+            {
+                if ( auto fn = llvm::dyn_cast< llvm::Function >( val ) )
+                    return "f " + std::to_string( function_index.at( fn ) );
+                if ( auto glob = llvm::dyn_cast< llvm::GlobalVariable >( val ) )
+                    return "g " + std::to_string( global_index.at( glob ) );
+                if ( auto arg = llvm::dyn_cast< llvm::Argument >( val ) )
+                    return "a " + std::to_string( function_index.at( arg->getParent() ) )
+                         + " " + std::to_string( arg->getArgNo() );
+                if ( auto inst = llvm::dyn_cast< llvm::Instruction >( val ) )
+                    return "i " + instruction( inst );
+                if ( auto ce = llvm::dyn_cast< llvm::ConstantExpr >( val ) ) {
+                    for ( auto &use : ce->uses() )
+                        if ( auto inst = llvm::dyn_cast< llvm::Instruction >( use.getUser() ) )
+                            return "c " + instruction( inst ) + " " + std::to_string( use.getOperandNo() );
+                }
+                return std::nullopt;
+            }
+
+            llvm::Value * value( std::istream &is ) const
+            {
+                char kind;
+                size_t fn = 0, idx = 0, op = 0;
+                is >> kind >> fn;
+                if ( kind != 'f' && kind != 'g' )
+                    is >> idx;
+                if ( kind == 'c' )
+                    is >> op;
+
+                if ( !is )
+                    return nullptr;
+
+                auto in_range = [] ( const auto &vec, size_t i ) { return i < vec.size(); };
+
+                switch ( kind ) {
+                    case 'f':
+                        return in_range( functions, fn ) ? functions[ fn ] : nullptr;
+                    case 'g':
+                        return in_range( globals, fn ) ? globals[ fn ] : nullptr;
+                    case 'a':
+                        if ( in_range( functions, fn ) && idx < functions[ fn ]->arg_size() )
+                            return functions[ fn ]->getArg( unsigned( idx ) );
+                        return nullptr;
+                    case 'i':
+                        if ( in_range( instructions, fn ) && in_range( instructions[ fn ], idx ) )
+                            return instructions[ fn ][ idx ];
+                        return nullptr;
+                    case 'c':
+                        if ( in_range( instructions, fn ) && in_range( instructions[ fn ], idx ) ) {
+                            auto inst = instructions[ fn ][ idx ];
+                            if ( op < inst->getNumOperands() )
+                                return llvm::dyn_cast< llvm::ConstantExpr >( inst->getOperand( unsigned( op ) ) );
+                        }
+                        return nullptr;
+                    default:
+                        return nullptr;
+                }
+            }
+
+            std::vector< llvm::Function * > functions;
+            std::vector< llvm::GlobalVariable * > globals;
+            std::vector< std::vector< llvm::Instruction * > > instructions;
+
+            std::unordered_map< llvm::Function *, size_t > function_index;
+            std::unordered_map< llvm::GlobalVariable *, size_t > global_index;
+            std::unordered_map< llvm::Instruction *, size_t > instruction_index;
+        };
+
+    } // anonymous namespace
+
+    analysis_cache::analysis_cache( llvm::Module &m )
+        : module( m )
+    {
+        if ( auto dir = options::get().cache; !dir.empty() )
+            path = dir / ( module_hash( m ) + ".dfa" );
+    }
+
+    std::optional< dfa::types > analysis_cache::load()
+    {
+        if ( !enabled() )
+            return std::nullopt;
+
+        std::ifstream is( path );
+        if ( !is ) {
+            spdlog::debug( "[cache] miss {}", path.string() );
+            return std::nullopt;
+        }
+
+        auto invalid = [&] {
+            spdlog::warn( "[cache] ignoring invalid entry {}", path.string() );
+            return std::nullopt;
+        };
+
+        std::string header;
+        size_t preprocessed = 0, values = 0;
+        is >> header >> preprocessed;
+        if ( !is || header != "lartcc-dfa" )
+            return invalid();
+
+        std::vector< llvm::Function * > functions;
+        for ( auto &fn : module )
+            functions.push_back( &fn );
+
+        preprocessor prep( module );
+        for ( size_t i = 0; i < preprocessed; ++i ) {
+            size_t fn;
+            if ( !( is >> fn ) || fn >= functions.size() )
+                return invalid();
+            prep.run( functions[ fn ] );
+        }
+
+        numbering positions( module );
+
+        dfa::types types;
+        is >> values;
+        for ( size_t i = 0; i < values; ++i ) {
+            dfa::types::type::data_t data;
+            is >> std::hex >> data >> std::dec;
+            auto val = positions.value( is );
+            if ( !is || !val )
+                return invalid();
+            types.emplace( val, dfa::types::type::from_data( data ) );
+        }
+
+        spdlog::info( "[cache] reusing analysis results {}", path.string() );
+        return types;
+    }
+
+    void analysis_cache::store( const dfa::types &types )
+    {
+        if ( !enabled() )
+            return;
+
+        numbering positions( module );
+
+        std::vector< size_t > preprocessed;
+        for ( size_t i = 0; i < positions.functions.size(); ++i )
+            if ( is_preprocessed( *positions.functions[ i ] ) )
+                preprocessed.push_back( i );
+
+        std::vector< std::pair< std::string, dfa::types::type > > entries;
+        for ( const auto &[val, type] : types ) {
+            auto pos = positions.position( val );
+            if ( !pos ) {
+                spdlog::debug( "[cache] results refer to a value without position, not cached" );
+                return;
+            }
+            entries.emplace_back( pos.value(), type );
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories( path.parent_path(), ec );
+
+        // write to a private file first, concurrent compilations of the same
+        // module may store the same entry
+        auto tmp = path;
+        tmp += "." + std::to_string( getpid() );
+
+        {
+            std::ofstream os( tmp );
+            os << "lartcc-dfa " << preprocessed.size();
+            for ( auto fn : preprocessed )
+                os << " " << fn;
+            os << "\n" << entries.size() << "\n";
+            for ( const auto &[pos, type] : entries )
+                os << std::hex << type.data() << std::dec << " " << pos << "\n";
+
+            if ( !os ) {
+                spdlog::warn( "[cache] unable to write {}", tmp.string() );
+                std::filesystem::remove( tmp, ec );
+                return;
+            }
+        }
+
+        std::filesystem::rename( tmp, path, ec );
+        if ( ec )
+            spdlog::warn( "[cache] unable to store {}: {}", path.string(), ec.message() );
+        else
+            spdlog::debug( "[cache] stored {}", path.string() );
+    }
+
+} // namespace lart
@@ -19,19 +19,37 @@
 #include <cc/dfa.hpp>
 
 #include <cc/alias.hpp>
+#include <cc/cache.hpp>
 #include <cc/util.hpp>
 #include <cc/logger.hpp>
 
 #include <llvm/Support/ErrorHandling.h>
-#include <svf/SVF-FE/SVFIRBuilder.h>
-#include <svf/SVF-FE/LLVMModule.h>
-#include <svf/WPA/Andersen.h>
 
 
 #include <llvm/IR/IntrinsicInst.h>
+#include <llvm/ADT/PostOrderIterator.h>
+#include <llvm/IR/CFG.h>
+
+#include <algorithm>
+#include <chrono>
 
 namespace lart::dfa {
 
+    types analysis::run_on( sc::module_ref m )
+    {
+        analysis_cache cache( m );
+        if ( auto cached = cache.load() )
+            return std::move( cached.value() );
+
+        spdlog::debug( "[dfa] start dataflow analysis" );
+        analysis dfa( m );
+        auto roots = gather_roots( m );
+        auto result = dfa.impl.run_from( roots );
+
+        cache.store( result );
+        return result;
+    }
+
     bool is_abstract( const dfa::types::type &type )
     {
         return static_cast< bool >( type.back().abstract );
@@ -42,6 +60,52 @@ namespace lart::dfa {
         return static_cast< bool >( type.back().pointer ) && is_abstract( type );
     }
 
+    std::unordered_set< llvm::Value * > definitely_abstract( const types &types )
+    {
+        auto generator = [] ( llvm::Value *v ) {
+            if ( auto call = llvm::dyn_cast< llvm::CallInst >( v ) )
+                if ( auto fn = call->getCalledFunction() )
+                    return fn->getName().startswith( "__lamp_any" );
+            return false;
+        };
+
+        auto lifted = [] ( llvm::Value *v ) {
+            return util::is_one_of< llvm::BinaryOperator, llvm::CastInst, llvm::CmpInst, llvm::PHINode >( v );
+        };
+
+        // start from all candidates and remove those that may be concrete,
+        // values in loops are abstract if they are on entry to the loop
+        std::unordered_set< llvm::Value * > result;
+        for ( const auto &[val, type] : types )
+            if ( !val->getType()->isPointerTy() && is_abstract( type ) && ( generator( val ) || lifted( val ) ) )
+                result.insert( val );
+
+        auto abstract = [&] ( llvm::Value *v ) { return result.count( v ) != 0; };
+
+        auto holds = [&] ( llvm::Value *v ) {
+            if ( generator( v ) )
+                return true;
+            auto inst = llvm::cast< llvm::Instruction >( v );
+            if ( llvm::isa< llvm::PHINode >( inst ) )
+                return std::all_of( inst->op_begin(), inst->op_end(), abstract );
+            return std::any_of( inst->op_begin(), inst->op_end(), abstract );
+        };
+
+        for ( bool changed = true; changed; ) {
+            changed = false;
+            for ( auto it = result.begin(); it != result.end(); ) {
+                if ( holds( *it ) ) {
+                    ++it;
+                } else {
+                    it = result.erase( it );
+                    changed = true;
+                }
+            }
+        }
+
+        return result;
+    }
+
 } // namespace lart::dfa
 
 namespace lart::dfa::detail
@@ -66,30 +130,73 @@ namespace lart::dfa::detail
         return mod->getFunction( name.str() );
     }
 
-    void dataflow_analysis::push( edge &&e ) noexcept
-    {
-        // spdlog::debug( "[dfa] push {}", e );
-        worklist.push( e );
-    }
+    static constexpr priority last_position = 0xFFFF'FFFF;
 
     void dataflow_analysis::push( llvm::Value *v ) noexcept
     {
         if ( llvm::isa< llvm::ConstantData >( v ) )
             return; //ignore
 
-        if ( util::is_one_of< llvm::Instruction, llvm::Argument >( v ) )
-            prep.run( sc::get_function( v ) );
-
-        for ( auto && e : edges( v ) )
-            push( std::move( e ) );
+        if ( queued.insert( v ).second )
+            worklist.push( { order( v ), v } );
     }
 
-    auto dataflow_analysis::pop() noexcept -> edge
+    llvm::Value * dataflow_analysis::pop() noexcept
     {
-        auto e = worklist.front();
+        auto v = worklist.top().value;
         worklist.pop();
-        // spdlog::debug( "[dfa] pop {}", e );
-        return e;
+        queued.erase( v );
+        return v;
+    }
+
+    priority dataflow_analysis::order( llvm::Value *v )
+    {
+        auto in_function = [&] ( llvm::Function *fn, priority position ) {
+            auto it = function_order.try_emplace( fn, function_order.size() + 1 ).first;
+            return it->second << 32 | position;
+        };
+
+        // return value of a function follows its body
+        if ( auto fn = llvm::dyn_cast< llvm::Function >( v ) )
+            return in_function( fn, last_position );
+
+        if ( util::is_one_of< llvm::Instruction, llvm::Argument >( v ) ) {
+            auto fn = sc::get_function( v );
+            prep.run( fn );
+            enumerate( fn );
+            auto it = priorities.find( v );
+            return in_function( fn, it != priorities.end() ? it->second : last_position - 1 );
+        }
+
+        return nonlocal_count++;
+    }
+
+    void dataflow_analysis::enumerate( llvm::Function *fn )
+    {
+        if ( !priorities.try_emplace( fn, last_position ).second )
+            return;
+
+        priority position = 0;
+        for ( auto &arg : fn->args() )
+            priorities[ &arg ] = position++;
+
+        if ( fn->isDeclaration() )
+            return;
+
+        for ( auto bb : llvm::ReversePostOrderTraversal< llvm::Function * >( fn ) )
+            for ( auto &inst : *bb )
+                priorities[ &inst ] = position++;
+    }
+
+    const edges_t &dataflow_analysis::successors( llvm::Value *v )
+    {
+        if ( util::is_one_of< llvm::GlobalValue, llvm::ConstantExpr >( v ) )
+            return edge_cache[ v ] = edges( v );
+
+        auto [it, inserted] = edge_cache.try_emplace( v );
+        if ( inserted )
+            it->second = edges( v );
+        return it->second;
     }
 
     sc::generator< llvm::Function * > dataflow_analysis::destinations( llvm::CallBase *call )
@@ -174,7 +281,7 @@ namespace lart::dfa::detail
         auto uses = [&] ( auto val ) {
             if ( auto s = llvm::dyn_cast< llvm::StoreInst >(val) ) {
                 for ( auto p : aliases.pointsto( s->getPointerOperand() ) ) {
-                    push( store_edge( v, p ) );
+                    edges.push_back( store_edge( v, p ) );
                 }
             }
             /*if ( auto aml = dfg.gv_to_aml( node ) )
@@ -244,30 +351,36 @@ namespace lart::dfa::detail
 
     type_map dataflow_analysis::run_from( const roots_map &roots )
     {
-        spdlog::debug( "[dfa] setup svf module" );
-        auto svfmodule = SVF::LLVMModuleSet::getLLVMModuleSet()->buildSVFModule( module );
-        svfmodule->buildSymbolTableInfo();
-        assert( svfmodule != nullptr && "SVF Module is null" );
-
-        SVF::SVFIRBuilder builder;
-        auto svfir = builder.build( svfmodule );
-        assert( svfir != nullptr && "SVFIR is null" );
-
-        aliases.init( svfir );
+        auto start = std::chrono::steady_clock::now();
 
         for (const auto  &[call, kind] : roots) {
             types.add( call, kind );
             push( call );
         }
 
+        size_t processed = 0;
         while (!worklist.empty()) {
             process( pop() );
+            ++processed;
         }
 
+        auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >(
+            std::chrono::steady_clock::now() - start
+        );
+
+        spdlog::debug( "[dfa] propagation took {} ms: {} values, {} processed",
+            elapsed.count(), types.size(), processed );
+
         return types;
     }
 
-    void dataflow_analysis::process( edge &&e )
+    void dataflow_analysis::process( llvm::Value *v )
+    {
+        for ( const auto &e : successors( v ) )
+            process( e );
+    }
+
+    void dataflow_analysis::process( const edge &e )
     {
         auto to = types[ e.to ];
         auto from = types[ e.from ];
@@ -23,6 +23,9 @@
 #include <cc/logger.hpp>
 #include <cc/preprocess.hpp>
 #include <cc/runtime.hpp>
+#include <cc/stats.hpp>
+#include <cc/taint.hpp>
+#include <cc/widen.hpp>
 
 #include <cc/backend/native/native.hpp>
 
@@ -42,11 +45,26 @@ namespace lart
 
         runtime::initialize( module );
 
+        auto &stats = statistics::get();
+        dfa::types types;
+
         // propagate abstraction type from annotated roots
-        auto types = dfa::analysis::run_on( module );
+        {
+            auto phase = stats.phase( "dfa" );
+            types = dfa::analysis::run_on( module );
+        }
+
+        // widen loop-carried values of loops with abstract exit conditions,
+        // widening calls are new roots, hence the analysis is rerun
+        {
+            auto phase = stats.phase( "widen" );
+            if ( loop_widening( module, types ).run() )
+                types = dfa::analysis::run_on( module );
+        }
 
         // lower pointer arithmetic to scalar operations
         {
+            auto phase = stats.phase( "lower pointers" );
             sc::deferred_erase_vector erase([&] (auto inst) { types.erase(inst); });
 
             for ( auto &[val, type] : types ) {
@@ -66,15 +84,21 @@ namespace lart
         syntactic syn( module, types, shadows );
 
         // generate unstash before shadow pass to use unstashed values as shadows
-        for ( const auto &op : syn.unstash_toprocess() ) {
-            if ( auto intr = syn.process( op ) ) {
-                intrinsics.push_back( intr.value() );
+        {
+            auto phase = stats.phase( "unstash" );
+            for ( const auto &op : syn.unstash_toprocess() ) {
+                if ( auto intr = syn.process( op ) ) {
+                    intrinsics.push_back( intr.value() );
+                }
             }
         }
 
         // generate shodows
-        for (const auto &op : shadows.toprocess()) {
-            shadows.process(op);
+        {
+            auto phase = stats.phase( "shadows" );
+            for (const auto &op : shadows.toprocess()) {
+                shadows.process(op);
+            }
         }
 
         std::set< sc::function > seen;
@@ -92,13 +116,16 @@ namespace lart
         };
 
         // syntactic pass
-        for ( const auto &op : syn.toprocess() ) {
-            if (auto fn = function(op)) {
-                seen.insert(fn);
-            }
+        {
+            auto phase = stats.phase( "syntactic" );
+            for ( const auto &op : syn.toprocess() ) {
+                if (auto fn = function(op)) {
+                    seen.insert(fn);
+                }
 
-            if ( auto intr = syn.process( op ) ) {
-                intrinsics.push_back( intr.value() );
+                if ( auto intr = syn.process( op ) ) {
+                    intrinsics.push_back( intr.value() );
+                }
             }
         }
 
@@ -108,21 +135,66 @@ namespace lart
         // 7. interrupts ?
 
         // TODO pick backend based on cmd arguments
-        auto backend = lart::backend::native( module );
-        for ( auto intr : intrinsics ) {
-            backend.lower( intr );
+        {
+            auto phase = stats.phase( "backend" );
+            auto backend = lart::backend::native( module );
+            for ( auto intr : intrinsics ) {
+                backend.lower( intr );
+            }
+
+            for ( auto intr : intrinsics ) {
+                if (op::faultable(intr.op)) {
+                    llvm::cast< sc::instruction >(op::replaces(intr.op).value())->eraseFromParent();
+                }
+            }
+        }
+
+        // remove repeated tests of memory taint, only the concrete code and
+        // the runtime calls remain at this point
+        if ( auto test = module.getFunction( "__lart_test_taint" ) ) {
+            auto phase = stats.phase( "taint tests" );
+
+            std::set< llvm::Function * > tested;
+            for ( auto user : test->users() )
+                if ( auto call = llvm::dyn_cast< llvm::CallInst >( user ) )
+                    tested.insert( call->getFunction() );
+
+            for ( auto fn : tested ) {
+                auto [eliminated, hoisted] = taint::eliminate_redundant_tests( *fn );
+                stats.count( "taint_tests_eliminated", eliminated );
+                stats.count( "taint_tests_hoisted", hoisted );
+            }
         }
 
-        for ( auto intr : intrinsics ) {
-            if (op::faultable(intr.op)) {
-                llvm::cast< sc::instruction >(op::replaces(intr.op).value())->eraseFromParent();
+        {
+            auto phase = stats.phase( "frames" );
+            for (auto fn : seen) {
+                make_shadow_frame(fn);
             }
         }
 
-        for (auto fn : seen) {
-            make_shadow_frame(fn);
+        for ( const auto &[val, type] : types ) {
+            if ( dfa::is_abstract_pointer( type ) )
+                stats.count( "abstract_pointers" );
+            else if ( dfa::is_abstract( type ) )
+                stats.count( "abstract_scalars" );
+        }
+
+        stats.count( "operations", intrinsics.size() );
+        stats.count( "frames", seen.size() );
+
+        for ( auto &fn : module ) {
+            auto name = fn.getName();
+            if ( name.startswith( "lart.lifter." ) )
+                stats.count( "lifters" );
+            if ( name.startswith( "lart.test.taint." ) ) {
+                stats.count( "taint_tests" );
+                stats.count( "taint_checks", fn.getNumUses() );
+            }
         }
 
+        stats.report( module.getModuleIdentifier() );
+        stats = statistics();
         spdlog::info("lartcc finished");
         return llvm::PreservedAnalyses::none();
     }
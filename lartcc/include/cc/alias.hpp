@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cc/logger.hpp>
+#include <cc/options.hpp>
 
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
@@ -26,36 +27,49 @@
 
 #include <sc/generator.hpp>
 
+#include <memory>
 #include <queue>
 
 namespace lart::aa
 {
-    struct andersen
+    /* Points-to analysis of the module runs on the first query, the sparse
+     * value-flow graph is built only when uses of a value are queried. */
+    struct alias_analysis
     {
-        void init( SVF::SVFIR * pag )
-        {
-            pta = SVF::AndersenWaveDiff::createAndersenWaveDiff( pag );
-            callgraph = pta->getPTACallGraph();
+        explicit alias_analysis( llvm::Module &m, alias_kind k = options::get().alias )
+            : module( m ), kind( k )
+        {}
 
-            value_flow_graph = std::make_unique< SVF::VFG >( callgraph );
+        void init();
+        void build_value_flow();
 
-            SVF::SVFGBuilder value_flow_builder(true);
-            value_flow = std::unique_ptr< SVF::SVFG >( value_flow_builder.buildFullSVFG(pta) );
+        SVF::BVDataPTAImpl * analysis()
+        {
+            if ( !pta )
+                init();
+            return pta;
+        }
+
+        SVF::SVFG * value_flow_graph()
+        {
+            if ( !value_flow )
+                build_value_flow();
+            return value_flow.get();
         }
 
         inline auto node( const llvm::Value *value )
         {
-            return pta->getPAG()->getValueNode(value);
+            return analysis()->getPAG()->getValueNode(value);
         }
 
         inline auto pta_node( const llvm::Value *value)
         {
-            return pta->getPAG()->getGNode( node(value) );
+            return analysis()->getPAG()->getGNode( node(value) );
         }
 
         inline auto value_flow_node( const llvm::Value *value )
         {
-            return value_flow->getDefSVFGNode( pta_node(value) );
+            return value_flow_graph()->getDefSVFGNode( pta_node(value) );
         }
 
         inline sc::generator< llvm::Value * > pointsto( llvm::Value *value )
@@ -63,7 +77,7 @@ namespace lart::aa
             auto to_value = [&] (auto node) {
                 return const_cast< llvm::Value * >( node->getValue() );
             };
-            for (auto pts : pta->getPts( node( value ) ) ) {
+            for (auto pts : analysis()->getPts( node( value ) ) ) {
                 auto target = pta->getPAG()->getGNode(pts);
                 if ( target->hasValue() ) {
                     co_yield to_value( target );
@@ -75,8 +89,9 @@ namespace lart::aa
 
         inline sc::generator< llvm::Value * > uses( llvm::Value *value )
         {
+            auto graph = value_flow_graph();
             auto to_value = [&] (auto node) {
-                return const_cast< llvm::Value * >(value_flow->getLHSTopLevPtr(node)->getValue());
+                return const_cast< llvm::Value * >(graph->getLHSTopLevPtr(node)->getValue());
             };
 
             std::queue< const value_flow_node_t* > worklist;
@@ -99,10 +114,10 @@ namespace lart::aa
             }
         }
 
-        SVF::PTACallGraph * callgraph = nullptr;
-        SVF::AndersenWaveDiff * pta = nullptr;
+        llvm::Module &module;
+        alias_kind kind;
 
-        std::unique_ptr< SVF::VFG > value_flow_graph;
+        SVF::BVDataPTAImpl * pta = nullptr;
         std::unique_ptr< SVF::SVFG > value_flow;
     };
 
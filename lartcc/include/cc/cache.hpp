@@ -0,0 +1,48 @@
+/*
+ * (c) 2020, 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <cc/dfa.hpp>
+
+#include <llvm/IR/Module.h>
+
+#include <filesystem>
+#include <optional>
+
+namespace lart
+{
+    /* On-disk cache of abstraction types computed by the dataflow analysis,
+     * keyed by a hash of the module and of the options that affect the
+     * analysis. Values are stored by their position in the module, the
+     * analysis preprocesses functions it reaches, hence the preprocessed
+     * functions are stored as well and their preprocessing is replayed when
+     * the entry is loaded. */
+    struct analysis_cache
+    {
+        explicit analysis_cache( llvm::Module &m );
+
+        std::optional< dfa::types > load();
+        void store( const dfa::types &types );
+
+        bool enabled() const { return !path.empty(); }
+
+        llvm::Module &module;
+        std::filesystem::path path;
+    };
+
+} // namespace lart
@@ -32,11 +32,14 @@
 #include <sc/init.hpp>
 #include <sc/format.hpp>
 
+#include <algorithm>
 #include <vector>
 #include <cassert>
 #include <iostream>
-#include <experimental/iterator>
+#include <cstdint>
+#include <queue>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace lart::dfa
 {
@@ -66,61 +69,123 @@ namespace detail
         return { join( a.pointer, b.pointer ), join( a.abstract, b.abstract ) };
     }
 
-    using type_vector = std::vector< type_layer >;
-
-    struct type_onion : type_vector
+    /* Layers of the onion are packed by four bits (two bits per tristate)
+     * into a single word, the topmost four bits keep the number of layers.
+     * Nesting deeper than `max_layers` saturates: the innermost layers are
+     * merged into a maybe-pointer front layer, as `join` does for onions of
+     * different depth. */
+    struct type_onion
     {
+        using data_t = uint64_t;
+
+        static constexpr size_t layer_bits = 4;
+        static constexpr size_t size_shift = 60;
+        static constexpr size_t max_layers = size_shift / layer_bits;
+
         type_onion( size_t ptr_nest )
-            : type_vector( ptr_nest + 1, type_layer( true, false ) )
         {
-            front() = type_layer( false, false );
+            auto layers = std::min( ptr_nest + 1, max_layers );
+            for ( size_t i = 0; i < layers; ++i )
+                push_back( type_layer( true, false ) );
+            auto merged = layers <= ptr_nest;
+            set_front( { merged ? tristate( tristate::maybe ) : tristate( false ), tristate( false ) } );
+        }
+
+        type_onion( std::initializer_list< type_layer > il )
+        {
+            for ( auto l : il )
+                push_back( l );
+        }
+
+        size_t size() const { return _data >> size_shift; }
+
+        type_layer operator[]( size_t i ) const
+        {
+            auto bits = ( _data >> ( i * layer_bits ) ) & 0xF;
+            return { decode( bits & 0x3 ), decode( bits >> 2 ) };
+        }
+
+        type_layer front() const { return ( *this )[ 0 ]; }
+        type_layer back() const { return ( *this )[ size() - 1 ]; }
+
+        void set( size_t i, type_layer l )
+        {
+            auto shift = i * layer_bits;
+            auto bits = data_t( l.pointer.value ) | data_t( l.abstract.value ) << 2;
+            _data = ( _data & ~( data_t( 0xF ) << shift ) ) | bits << shift;
+        }
+
+        void set_front( type_layer l ) { set( 0, l ); }
+        void set_back( type_layer l ) { set( size() - 1, l ); }
+
+        void push_back( type_layer l )
+        {
+            auto n = size();
+            if ( n == max_layers )
+                merge_front(), --n;
+            resize( n + 1 );
+            set( n, l );
         }
 
-        type_onion( const type_vector &l ) : type_vector( l ) {}
-        type_onion( std::initializer_list< type_layer > il ) : type_vector( il ) {}
+        void pop_back()
+        {
+            auto n = size() - 1;
+            _data &= ~( data_t( 0xF ) << ( n * layer_bits ) );
+            resize( n );
+        }
+
+        bool operator==( const type_onion & ) const = default;
+
+        data_t data() const { return _data; }
+
+        static type_onion from_data( data_t data )
+        {
+            type_onion rv( size_t( 0 ) );
+            rv._data = data;
+            return rv;
+        }
 
         type_onion make_abstract() const
         {
             auto rv = *this;
-            rv.back().abstract = tristate(true);
+            rv.set_back( { back().pointer, tristate( true ) } );
             return rv;
         }
 
         type_onion make_pointer() const
         {
             auto rv = *this;
-            rv.back().pointer = tristate(true);
+            rv.set_back( { tristate( true ), back().abstract } );
             return rv;
         }
 
         type_onion make_abstract_pointer() const
         {
             auto on = this->make_abstract().make_pointer();
-            on.front().abstract = tristate::maybe;
-            on.front().pointer = tristate::maybe;
+            on.set_front( { tristate( tristate::maybe ), tristate( tristate::maybe ) } );
             return on;
         }
 
         bool maybe_abstract() const
         {
             tristate r( false );
-            for ( auto a : *this )
-                r = join( r, a.abstract );
+            for ( size_t i = 0; i < size(); ++i )
+                r = join( r, ( *this )[ i ].abstract );
             return r.value != tristate::no;
         }
 
         bool maybe_pointer() const
         {
             tristate r( false );
-            for ( auto a : *this )
-                r = join( r, a.pointer );
+            for ( size_t i = 0; i < size(); ++i )
+                r = join( r, ( *this )[ i ].pointer );
             return r.value != tristate::no;
         }
 
         type_onion wrap() const
         {
             auto rv = *this;
-            rv.emplace_back( true, false );
+            rv.push_back( type_layer( true, false ) );
             return rv;
         }
 
@@ -128,7 +193,7 @@ namespace detail
         {
             auto rv = *this;
             if ( size() == 1 )
-                rv.front().pointer = tristate::maybe;
+                rv.set_front( { tristate( tristate::maybe ), front().abstract } );
             else
             {
                 assert( back().pointer != tristate( false ) );
@@ -141,10 +206,30 @@ namespace detail
         friend auto operator<<( stream &s, type_onion t ) -> decltype( s << "" )
         {
             s << '[';
-            std::copy(t.begin(), t.end(), std::experimental::make_ostream_joiner(s, ", "));
+            for ( size_t i = 0; i < t.size(); ++i )
+                s << ( i ? ", " : "" ) << t[ i ];
             s << "]";
             return s;
         }
+
+    private:
+        static tristate decode( data_t bits ) { return tristate( decltype( tristate::value )( bits ) ); }
+
+        void merge_front()
+        {
+            auto front = join( ( *this )[ 0 ], ( *this )[ 1 ] );
+            auto layers = _data & ~( data_t( 0xF ) << size_shift );
+            _data = layers >> layer_bits;
+            resize( max_layers - 1 );
+            set_front( { tristate( tristate::maybe ), front.abstract } );
+        }
+
+        void resize( size_t n )
+        {
+            _data = ( _data & ~( data_t( 0xF ) << size_shift ) ) | data_t( n ) << size_shift;
+        }
+
+        data_t _data = 0;
     };
 
     inline type_onion join( type_onion a, type_onion b )
@@ -152,15 +237,17 @@ namespace detail
         if ( a.size() > b.size() )
             std::swap( a, b );
 
-        if ( a.size() < b.size() )
+        auto diff = b.size() - a.size();
+        if ( diff )
         {
-            for ( size_t i = 0; i < b.size() - a.size(); ++i )
-                a.front() = join( a.front(), b[ i ] );
-            a.front().pointer = tristate::maybe;
+            auto front = a.front();
+            for ( size_t i = 0; i < diff; ++i )
+                front = join( front, b[ i ] );
+            a.set_front( { tristate( tristate::maybe ), front.abstract } );
         }
 
         for ( size_t i = 0; i < a.size(); ++i )
-            a[ i ] = join( a[ i ], b[ i + b.size() - a.size() ] );
+            a.set( i, join( a[ i ], b[ i + diff ] ) );
 
         return a;
     }
@@ -249,31 +336,63 @@ namespace detail
 
     using edges_t = std::vector< edge >;
 
+    /* Values are processed in the order of their functions' discovery and
+     * within a function in reverse postorder of basic blocks, so definitions
+     * are mostly settled before their uses. Non-local values (globals,
+     * constant expressions) go first. */
+    using priority = uint64_t;
+
+    struct worklist_item
+    {
+        priority key;
+        llvm::Value *value;
+
+        bool operator>( const worklist_item &o ) const { return key > o.key; }
+    };
+
     struct dataflow_analysis : sc::with_context
     {
         explicit dataflow_analysis( llvm::Module &m )
-            : sc::with_context( m ), module( m ), prep( m )
+            : sc::with_context( m ), aliases( m ), module( m ), prep( m )
         {}
 
-        void push( edge &&e ) noexcept;
         void push( llvm::Value *v ) noexcept;
-        edge pop() noexcept;
+        llvm::Value * pop() noexcept;
 
-        void process( edge &&e );
+        void process( llvm::Value *v );
+        void process( const edge &e );
+
+        const edges_t &successors( llvm::Value * v );
 
         edges_t edges( llvm::Value * v );
         edges_t induced_edges( llvm::Value * lhs, llvm::Value * rhs );
 
         sc::generator< llvm::Function * > destinations( llvm::CallBase *call );
 
+        priority order( llvm::Value *v );
+        void enumerate( llvm::Function *fn );
+
         void preprocess( llvm::Function * ) const;
 
         type_map run_from( const roots_map &roots );
 
-        std::queue< edge > worklist;
+        using queue = std::priority_queue< worklist_item, std::vector< worklist_item >, std::greater<> >;
+
+        queue worklist;
+        std::unordered_set< llvm::Value * > queued;
+
+        // edges do not depend on types, hence they are computed once per
+        // value, except for non-local values that gain uses as functions
+        // are preprocessed
+        std::unordered_map< llvm::Value *, edges_t > edge_cache;
+
+        std::unordered_map< llvm::Value *, priority > priorities;
+        std::unordered_map< llvm::Function *, priority > function_order;
+        priority nonlocal_count = 0;
+
         type_map types;
 
-        aa::andersen aliases;
+        aa::alias_analysis aliases;
 
         llvm::Module &module;
         preprocessor prep;
@@ -287,13 +406,7 @@ namespace detail
     {
         explicit analysis( sc::module_ref m ) : impl( m ) {}
 
-        static types run_on( sc::module_ref m )
-        {
-            spdlog::debug( "[dfa] start dataflow analysis" );
-            analysis dfa( m );
-            auto roots = gather_roots( m );
-            return dfa.impl.run_from( roots );
-        }
+        static types run_on( sc::module_ref m );
 
         detail::dataflow_analysis impl;
     };
@@ -302,4 +415,10 @@ namespace detail
 
     bool is_abstract_pointer( const dfa::types::type &type );
 
+    /* Values that are abstract whenever they are computed: results of
+     * generators of abstract values and of lifted operations with such an
+     * operand (or phis with only such incoming values). Their taint is set,
+     * hence they do not need to be tested at runtime. */
+    std::unordered_set< llvm::Value * > definitely_abstract( const types &types );
+
 } // namespace lart::dfa
@@ -26,8 +26,10 @@
 
 #include <llvm/IR/Value.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Operator.h>
 #include <llvm/Support/ErrorHandling.h>
 
+#include <sstream>
 #include <variant>
 #include <experimental/iterator>
 
@@ -526,15 +528,51 @@ namespace lart::op
         return out.has_value() ? extract_default( out.value(), types ) : sc::void_t();
     }
 
-    inline auto unique_name_suffix(const operation &o)
+    static inline char tag( argtype type ) {
+        switch (type) {
+            case argtype::test: return 'x';
+            case argtype::with_taint: return 't';
+            case argtype::concrete: return 'c';
+            case argtype::abstract: return 'a';
+            case argtype::unpack: return 'u';
+        }
+
+        llvm_unreachable( "unknown argument type" );
+    }
+
+    /* Generated functions (lifters and taint tests) depend only on the kind
+     * of the operation and on kinds and types of its arguments, operations
+     * with the same signature share them. */
+    inline std::string signature( const operation &o )
     {
-        std::stringstream suff;
-        auto args = arguments(o);
-        auto get_value = [] (auto op) { return op.value; };
-        auto fmt = sc::query::query( args ).map( get_value ).map( sc::query::type ).map( sc::fmt::type );
+        std::stringstream sig;
+        sig << name(o);
+        for ( const auto &arg : arguments(o) )
+            sig << "." << tag(arg.type) << sc::fmt::type( arg.value->getType() );
+        return sig.str();
+    }
+
+    /* Flags of the instruction that the concrete path of a faultable
+     * operation clones, operations differing in them can not share it. */
+    inline std::string clone_flags( const operation &o )
+    {
+        std::string flags;
+        if ( !faultable(o) )
+            return flags;
+
+        auto val = value(o);
+        if ( auto ovf = llvm::dyn_cast< llvm::OverflowingBinaryOperator >( val ) ) {
+            if ( ovf->hasNoUnsignedWrap() )
+                flags += ".nuw";
+            if ( ovf->hasNoSignedWrap() )
+                flags += ".nsw";
+        }
+
+        if ( auto exact = llvm::dyn_cast< llvm::PossiblyExactOperator >( val ) )
+            if ( exact->isExact() )
+                flags += ".exact";
 
-        std::copy(fmt.begin(), fmt.end(), std::experimental::make_ostream_joiner(suff, "."));
-        return suff.str();
+        return flags;
     }
 
     template< typename stream >
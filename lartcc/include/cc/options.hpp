@@ -0,0 +1,56 @@
+/*
+ * (c) 2020 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace lart
+{
+    enum class alias_kind { andersen, steensgaard };
+
+    /* Options of the lartcc pass, the lartcc wrapper passes them through
+     * environment variables (e.g., --lart-alias=steensgaard). */
+    struct options
+    {
+        // LARTCC_ALIAS: points-to analysis used for stores to abstract memory
+        alias_kind alias = alias_kind::andersen;
+
+        // LARTCC_CACHE: directory of cached analysis results, empty disables
+        // the cache
+        std::filesystem::path cache;
+
+        // LARTCC_STATS: file the statistics of the pass are appended to
+        std::filesystem::path stats;
+
+        // LARTCC_PRE_PIPELINE: textual pass pipeline run before the pass,
+        // e.g., function(sroa,mem2reg) to lift locals out of memory
+        std::string pre_pipeline;
+
+        // LARTCC_POST_PIPELINE: textual pass pipeline run after the pass
+        std::string post_pipeline;
+
+        static const options &get()
+        {
+            static const options opts = load();
+            return opts;
+        }
+
+        static options load();
+    };
+
+} // namespace lart
@@ -92,11 +92,21 @@ namespace lart::runtime
             return insert_and_annotate_operation("any_range_" + name, fty);
         }
 
+        sc::function register_varg_any(const std::string &name, sc::type to) {
+            auto fty = llvm::FunctionType::get( to, { sc::i32() }, true );
+            return insert_and_annotate_operation("any_varg_" + name, fty);
+        }
+
         sc::function register_lift(const std::string &name, sc::type from) {
             auto fty = llvm::FunctionType::get( from, { from }, false );
             return insert_and_annotate_operation("lift_" + name, fty);
         }
 
+        sc::function register_widen(const std::string &name, sc::type ty) {
+            auto fty = llvm::FunctionType::get( ty, { ty->getPointerTo(), sc::i32() }, false );
+            return insert_and_annotate_operation("widen_" + name, fty);
+        }
+
         sc::function register_wrap(const std::string &name, sc::type from) {
             auto fty = llvm::FunctionType::get( abstract_type(), { from }, false );
             return insert_lamp_operation("wrap_" + name, fty);
@@ -28,7 +28,7 @@ namespace lart
     using operation = lart::op::operation;
 
     enum class shadow_op_kind {
-        source, memory, global, forward, store, load, freeze, melt, arg, ret
+        source, memory, global, forward, phi, store, load, freeze, melt, arg, ret
     };
 
     struct shadow_operation {
@@ -39,7 +39,7 @@ namespace lart
     struct shadow_map : sc::with_context
     {
         explicit shadow_map( sc::module_ref &m, const dfa::types &t )
-            : sc::with_context( m ), types( t ), module( m )
+            : sc::with_context( m ), types( t ), certain( dfa::definitely_abstract( t ) ), module( m )
         {}
 
         sc::generator< shadow_operation > toprocess();
@@ -53,6 +53,8 @@ namespace lart
 
         sc::value process_forward( shadow_operation op );
 
+        sc::value process_phi( shadow_operation op );
+
         sc::value process_load( shadow_operation op );
 
         sc::value process_store( shadow_operation op );
@@ -75,6 +77,10 @@ namespace lart
         std::unordered_map< sc::value, sc::value > ops;
 
         const dfa::types &types;
+
+        // values with statically known taint
+        std::unordered_set< sc::value > certain;
+
         sc::module_ref module;
     };
 
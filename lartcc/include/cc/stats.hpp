@@ -18,7 +18,52 @@
 
 #include <llvm/Support/Debug.h>
 
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace lart
 {
     using llvm::dbgs;
-}
+
+    /* Statistics of a run of the pass: phase times, peak memory and counts of
+     * abstract values and generated code. The report is appended as a single
+     * line of JSON to the file given by LARTCC_STATS. */
+    struct statistics
+    {
+        using clock = std::chrono::steady_clock;
+
+        /* times the phase until the end of its scope */
+        struct scope
+        {
+            ~scope()
+            {
+                auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >( clock::now() - start );
+                stats.phases.emplace_back( std::move( name ), elapsed.count() );
+            }
+
+            statistics &stats;
+            std::string name;
+            clock::time_point start;
+        };
+
+        [[nodiscard]] scope phase( std::string name ) { return { *this, std::move( name ), clock::now() }; }
+
+        void count( const std::string &name, size_t n = 1 ) { counts[ name ] += n; }
+
+        void report( const std::string &module ) const;
+
+        static statistics &get()
+        {
+            static statistics stats;
+            return stats;
+        }
+
+        // wall-clock times of the phases in the order they ran
+        std::vector< std::pair< std::string, long > > phases;
+        std::map< std::string, size_t > counts;
+    };
+
+} // namespace lart
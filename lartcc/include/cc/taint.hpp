@@ -33,4 +33,17 @@ namespace lart::taint
 
     sc::generator< ir::argument > paired_view( const ir::intrinsic &test );
 
+    struct redundancy
+    {
+        size_t eliminated = 0;
+        size_t hoisted = 0;
+    };
+
+    /* Taint of memory changes only in calls (freezing abstract values and
+     * releasing frames), hence a test of the same memory is redundant until
+     * the next call and a test in a loop without calls is loop invariant.
+     * Repeated tests in a block are removed and invariant tests are hoisted
+     * to loop preheaders. */
+    redundancy eliminate_redundant_tests( llvm::Function &fn );
+
 } // namespace lart::taint
@@ -0,0 +1,64 @@
+/*
+ * (c) 2020, 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <cc/dfa.hpp>
+
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include <sc/init.hpp>
+
+#include <vector>
+
+namespace lart
+{
+    /* Loops whose exit depends on an abstract value would be explored one
+     * iteration at a time. At headers of such loops, loop-carried scalar
+     * variables are passed through `__lamp_widen_*`, which widens them after
+     * a configurable number of iterations (LART_WIDEN_AFTER). The path is
+     * cancelled once all the widened values become stable, provided they are
+     * the whole state carried by the loop. */
+    struct loop_widening : sc::with_context
+    {
+        loop_widening( llvm::Module &m, dfa::types &t )
+            : sc::with_context( m ), module( m ), types( t )
+        {}
+
+        /* returns whether any loop was instrumented */
+        bool run();
+
+        bool abstract_exit( llvm::Loop *loop );
+
+        bool maybe_abstract( llvm::Value *val ) const;
+
+        bool demote_header_phis( llvm::Loop *loop );
+
+        std::vector< llvm::AllocaInst * > loop_carried( llvm::Loop *loop );
+
+        bool whole_state( llvm::Loop *loop, const std::vector< llvm::AllocaInst * > &vars );
+
+        void widen( llvm::Loop *loop, const std::vector< llvm::AllocaInst * > &vars );
+
+        llvm::Module &module;
+        dfa::types &types;
+
+        unsigned sites = 0;
+    };
+
+} // namespace lart
@@ -118,7 +118,7 @@ namespace lart
 
     std::string lifter::name() const
     {
-        return "lart.lifter." + op::name(op) + "." + op::unique_name_suffix(op);
+        return "lart.lifter." + op::signature(op);
     }
 
     llvm::Function* lifter::function() const
@@ -158,6 +158,10 @@ namespace lart
     {
         assert( function()->empty() );
 
+        // lifters run only on the abstract path of inlined taint tests
+        function()->addFnAttr( llvm::Attribute::NoInline );
+        function()->addFnAttr( llvm::Attribute::Cold );
+
         auto bld = sc::stack_builder()
                  | sc::action::function{ function() }
                  | sc::action::create_block{ "entry" };
@@ -0,0 +1,54 @@
+/*
+ * (c) 2020 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cc/options.hpp>
+#include <cc/logger.hpp>
+
+#include <cstdlib>
+#include <string_view>
+
+namespace lart
+{
+    options options::load()
+    {
+        options opts;
+
+        if ( auto alias = std::getenv( "LARTCC_ALIAS" ) ) {
+            std::string_view kind = alias;
+            if ( kind == "andersen" )
+                opts.alias = alias_kind::andersen;
+            else if ( kind == "steensgaard" )
+                opts.alias = alias_kind::steensgaard;
+            else
+                spdlog::warn( "unknown alias analysis '{}', using andersen", kind );
+        }
+
+        if ( auto cache = std::getenv( "LARTCC_CACHE" ) )
+            opts.cache = cache;
+
+        if ( auto stats = std::getenv( "LARTCC_STATS" ) )
+            opts.stats = stats;
+
+        if ( auto pipeline = std::getenv( "LARTCC_PRE_PIPELINE" ) )
+            opts.pre_pipeline = pipeline;
+
+        if ( auto pipeline = std::getenv( "LARTCC_POST_PIPELINE" ) )
+            opts.post_pipeline = pipeline;
+
+        return opts;
+    }
+
+} // namespace lart
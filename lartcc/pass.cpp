@@ -15,6 +15,8 @@
  */
 
 #include <cc/pass.hpp>
+#include <cc/logger.hpp>
+#include <cc/options.hpp>
 #include <cc/stats.hpp>
 
 #include <llvm/Passes/PassPlugin.h>
@@ -29,6 +31,14 @@ namespace lart
         return _driver->run();
     }
 
+    static void add_pipeline( llvm::PassBuilder &bld, llvm::ModulePassManager &mgr, const std::string &text )
+    {
+        if ( text.empty() )
+            return;
+        if ( auto err = bld.parsePassPipeline( mgr, text ) )
+            spdlog::error( "invalid pipeline '{}': {}", text, llvm::toString( std::move( err ) ) );
+    }
+
 } // namespace lart
 
 llvm::PassPluginLibraryInfo get_lartcc_plugin_info() {
@@ -36,8 +46,11 @@ llvm::PassPluginLibraryInfo get_lartcc_plugin_info() {
         [](llvm::PassBuilder &bld) {
             // TODO find out the best spot to run lart
             bld.registerPipelineStartEPCallback(
-                [](llvm::ModulePassManager &mgr, llvm::PassBuilder::OptimizationLevel) {
-                    return mgr.addPass(lart::lartcc()), true;
+                [&bld](llvm::ModulePassManager &mgr, llvm::PassBuilder::OptimizationLevel) {
+                    const auto &opts = lart::options::get();
+                    lart::add_pipeline( bld, mgr, opts.pre_pipeline );
+                    mgr.addPass(lart::lartcc());
+                    lart::add_pipeline( bld, mgr, opts.post_pipeline );
                 }
             );
 
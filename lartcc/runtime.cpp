@@ -45,6 +45,11 @@ namespace lart::runtime
             runtime.register_range_any(name, to);
         });
 
+        register_for_primitives([&] (const auto &name, auto to) {
+            if (name != "i1")
+                runtime.register_varg_any(name, to);
+        });
+
         register_for_primitives([&] (const auto &name, auto from) {
             runtime.register_lift(name, from);
         });
@@ -27,6 +27,8 @@ namespace lart
                 return "memory";
             case shadow_op_kind::forward:
                 return "forward";
+            case shadow_op_kind::phi:
+                return "phi";
             case shadow_op_kind::store:
                 return "store";
             case shadow_op_kind::load:
@@ -82,6 +84,8 @@ namespace lart
             if ( fn->hasName() && fn->getName().startswith("__lamp" ) ) {
                 return shadow_op_kind::source;
             }
+        } else if ( llvm::isa< llvm::PHINode >(val) ) {
+            return shadow_op_kind::phi;
         } else if ( llvm::isa< llvm::Argument >(val) ) {
             return shadow_op_kind::arg;
         } else if ( llvm::isa< llvm::GlobalVariable >(val) ) {
@@ -113,6 +117,11 @@ namespace lart
             return ops[o.value];
         }
 
+        auto merges = o.kind == shadow_op_kind::forward || o.kind == shadow_op_kind::phi;
+        if (merges && certain.count(o.value)) {
+            return ops[o.value] = sc::i1( true );
+        }
+
         spdlog::debug("[shadow] make {} op: {}",
             to_string(o.kind),
             sc::fmt::llvm_to_string(o.value)
@@ -126,6 +135,8 @@ namespace lart
                     return process_memory(o);
                 case shadow_op_kind::forward:
                     return process_forward(o);
+                case shadow_op_kind::phi:
+                    return process_phi(o);
                 case shadow_op_kind::store:
                     return process_store(o);
                 case shadow_op_kind::load:
@@ -190,6 +201,22 @@ namespace lart
         return bld.back();
     }
 
+    sc::value shadow_map::process_phi( shadow_operation op ) {
+        auto concrete = llvm::cast< llvm::PHINode >( op.value );
+        auto phi = llvm::PHINode::Create( sc::i1(), concrete->getNumIncomingValues(),
+                                          concrete->getName() + ".taint", concrete );
+
+        // register the shadow before incoming values are processed,
+        // they may depend on the phi in loops
+        ops[concrete] = phi;
+
+        for ( unsigned i = 0; i < concrete->getNumIncomingValues(); ++i ) {
+            phi->addIncoming( process( concrete->getIncomingValue( i ) ), concrete->getIncomingBlock( i ) );
+        }
+
+        return phi;
+    }
+
     sc::value shadow_map::process_store( shadow_operation /* op */ ) {
         // TODO
         return nullptr; // store does not return any value
@@ -238,6 +265,10 @@ namespace lart
     }
 
     sc::value shadow_map::get( sc::value op ) const {
+        if ( certain.count(op) ) {
+            return sc::i1( true );
+        }
+
         if ( !ops.count(op) ) {
             return sc::i1(false);
         }
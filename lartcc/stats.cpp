@@ -0,0 +1,74 @@
+/*
+ * (c) 2020, 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <cc/stats.hpp>
+#include <cc/logger.hpp>
+#include <cc/options.hpp>
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+
+namespace lart
+{
+    void statistics::report( const std::string &module ) const
+    {
+        auto path = options::get().stats;
+        if ( path.empty() )
+            return;
+
+        // phases that run repeatedly (e.g., the analysis after widening) are summed
+        std::vector< std::pair< std::string, long > > summed;
+        for ( const auto &phase : phases ) {
+            auto same = [&] ( const auto &p ) { return p.first == phase.first; };
+            if ( auto it = std::find_if( summed.begin(), summed.end(), same ); it != summed.end() )
+                it->second += phase.second;
+            else
+                summed.push_back( phase );
+        }
+
+        rusage usage;
+        getrusage( RUSAGE_SELF, &usage );
+
+        std::error_code ec;
+        llvm::raw_fd_ostream os( path.string(), ec, llvm::sys::fs::OF_Append );
+        if ( ec ) {
+            spdlog::warn( "[lartcc] unable to write statistics to {}: {}", path.string(), ec.message() );
+            return;
+        }
+
+        llvm::json::OStream json( os );
+        json.object( [&] {
+            json.attribute( "module", module );
+            json.attributeObject( "phases", [&] {
+                for ( const auto &[name, ms] : summed )
+                    json.attribute( name, int64_t( ms ) );
+            } );
+            json.attribute( "peak_memory_kib", int64_t( usage.ru_maxrss ) );
+            json.attributeObject( "counts", [&] {
+                for ( const auto &[name, n] : counts )
+                    json.attribute( name, int64_t( n ) );
+            } );
+        } );
+        os << "\n";
+    }
+
+} // namespace lart
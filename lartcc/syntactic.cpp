@@ -231,7 +231,7 @@ namespace lart
         for (auto arg : op::duplicated_arguments(op, lift.shadows)) {
             args.push_back(arg);
         }
-        auto name = "lart." + op::name(op) + op::unique_name_suffix(op);
+        auto name = "lart." + op::signature(op);
         return { op::make_call( op, args, name ), op };
     }
 
@@ -285,30 +285,32 @@ namespace lart
             return std::nullopt;
         }
 
-        // TODO join with taint processing
+        // abstract values are merged by a phi of abstract pointers, incoming
+        // values that are not yet abstracted are placed when they are, taint
+        // is merged by the shadow pass
         if ( std::holds_alternative< op::phi >( o ) ) {
-            // auto concrete = llvm::cast< llvm::PHINode >( op::value(o) );
-            // llvm::IRBuilder<> irb( op::location(o) );
-            // auto aptr = op::abstract_pointer();
+            auto concrete = llvm::cast< llvm::PHINode >( op::value(o) );
+            auto aptr = op::abstract_pointer();
 
-            // auto phi = irb.CreatePHI( aptr->getType(), concrete->getNumIncomingValues() );
-            // for ( unsigned i = 0; i < concrete->getNumIncomingValues(); ++i ) {
-            //     phi->addIncoming( aptr, concrete->getIncomingBlock( i ) );
-            // }
-
-            // abstract[concrete] = phi;
+            auto phi = llvm::PHINode::Create( aptr->getType(), concrete->getNumIncomingValues(),
+                                              concrete->getName() + ".abstract", concrete );
+            for ( unsigned i = 0; i < concrete->getNumIncomingValues(); ++i ) {
+                phi->addIncoming( aptr, concrete->getIncomingBlock( i ) );
+            }
 
-            // for ( auto &arg : paired_view( concrete, phi ) ) {
-            //     auto &con = arg.concrete;
-            //     if ( auto abs = abstract.find( con.get() ); abs != abstract.end() )
-            //         arg.abstract.set( abs->second );
-            //     else
-            //         places[con].push_back( arg );
-            // }
+            abstract[concrete] = phi;
 
-            // update_places( concrete );
-            // propagate_identity( concrete );
+            for ( unsigned i = 0; i < concrete->getNumIncomingValues(); ++i ) {
+                auto &con = concrete->getOperandUse( i );
+                auto &abs = phi->getOperandUse( i );
+                if ( auto a = abstract.find( con.get() ); a != abstract.end() )
+                    abs.set( a->second );
+                else
+                    places[con].push_back( ir::arg::without_taint_abstract{ con, abs } );
+            }
 
+            update_places( concrete );
+            propagate_identity( concrete );
             return std::nullopt;
         }
 
@@ -20,13 +20,18 @@
 
 #include <sc/query.hpp>
 
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/Dominators.h>
+
+#include <map>
+
 namespace lart::taint
 {
     namespace detail
     {
         std::string name( const operation &op )
         {
-            return "lart.test.taint." + op::name(op) + "." + op::unique_name_suffix(op);
+            return "lart.test.taint." + op::signature(op) + op::clone_flags(op);
         }
 
         sc::generator< sc::value > arguments( const lart::lifter &lifter )
@@ -40,6 +45,140 @@ namespace lart::taint
 
     } // namespace detail
 
+    namespace detail
+    {
+        llvm::CallInst * as_test( llvm::Instruction &inst )
+        {
+            if ( auto call = llvm::dyn_cast< llvm::CallInst >( &inst ) )
+                if ( auto fn = call->getCalledFunction(); fn && fn->getName() == "__lart_test_taint" )
+                    return call;
+            return nullptr;
+        }
+
+        // runtime calls that do not change taint of memory
+        bool preserves_taint( llvm::StringRef name )
+        {
+            return name == "__lart_test_taint" || name == "__lart_stash"
+                || name == "__lart_unstash" || name == "__lart_unstash_taint";
+        }
+
+        bool clobbers( llvm::Instruction &inst );
+
+        /* Taint of memory is changed by freezing an abstract value (or storing
+         * through an abstract pointer), domain operations leave it intact.
+         * Generated taint tests and lifters change it only if they call
+         * a function that does. */
+        bool changes_taint( llvm::Function &fn )
+        {
+            auto name = fn.getName();
+            if ( name == "__lamp_freeze" || name == "__lamp_store" )
+                return true;
+            if ( name.startswith( "__lamp_" ) || preserves_taint( name ) )
+                return false;
+            if ( !name.startswith( "lart." ) || fn.isDeclaration() )
+                return !fn.onlyReadsMemory();
+
+            for ( auto &bb : fn )
+                for ( auto &inst : bb )
+                    if ( clobbers( inst ) )
+                        return true;
+            return false;
+        }
+
+        // calls that do not write memory keep taint as it is, unknown calls
+        // and intrinsics like memcpy or memset do not
+        bool clobbers( llvm::Instruction &inst )
+        {
+            auto call = llvm::dyn_cast< llvm::CallBase >( &inst );
+            if ( !call || call->onlyReadsMemory() )
+                return false;
+            if ( auto fn = call->getCalledFunction() )
+                return changes_taint( *fn );
+            return true;
+        }
+
+        using tested_memory = std::pair< llvm::Value *, llvm::Value * >;
+
+        tested_memory memory( llvm::CallInst *test )
+        {
+            return { test->getArgOperand( 0 )->stripPointerCasts(), test->getArgOperand( 1 ) };
+        }
+
+        size_t eliminate( llvm::BasicBlock &bb )
+        {
+            std::map< tested_memory, llvm::CallInst * > available;
+            std::vector< llvm::CallInst * > redundant;
+
+            for ( auto &inst : bb ) {
+                if ( auto test = as_test( inst ) ) {
+                    auto [it, fresh] = available.try_emplace( memory( test ), test );
+                    if ( !fresh ) {
+                        test->replaceAllUsesWith( it->second );
+                        redundant.push_back( test );
+                    }
+                } else if ( clobbers( inst ) ) {
+                    available.clear();
+                }
+            }
+
+            for ( auto test : redundant )
+                test->eraseFromParent();
+            return redundant.size();
+        }
+
+        size_t hoist( llvm::Loop *loop )
+        {
+            auto preheader = loop->getLoopPreheader();
+            if ( !preheader )
+                return 0;
+
+            std::vector< llvm::CallInst * > tests;
+            for ( auto bb : loop->blocks() ) {
+                for ( auto &inst : *bb ) {
+                    if ( auto test = as_test( inst ) )
+                        tests.push_back( test );
+                    else if ( clobbers( inst ) )
+                        return 0;
+                }
+            }
+
+            // the test only reads shadow memory, so it is safe to execute
+            // even if the loop body would not be
+            size_t hoisted = 0;
+            for ( auto test : tests ) {
+                bool changed = false;
+                auto ptr = test->getArgOperand( 0 );
+                if ( loop->makeLoopInvariant( ptr, changed, preheader->getTerminator() )
+                  && loop->isLoopInvariant( test->getArgOperand( 1 ) ) )
+                {
+                    test->moveBefore( preheader->getTerminator() );
+                    ++hoisted;
+                }
+            }
+
+            return hoisted;
+        }
+
+    } // namespace detail
+
+    redundancy eliminate_redundant_tests( llvm::Function &fn )
+    {
+        redundancy result;
+
+        llvm::DominatorTree dt( fn );
+        llvm::LoopInfo loops( dt );
+
+        // inner loops first, tests hoisted to their preheaders may be hoisted
+        // further from the enclosing loops
+        for ( auto loop : llvm::reverse( loops.getLoopsInPreorder() ) )
+            result.hoisted += detail::hoist( loop );
+
+        for ( auto &bb : fn )
+            result.eliminated += detail::eliminate( bb );
+
+        return result;
+    }
+
     llvm::CallInst * make_call( const lifter &lift )
     {
         std::vector< sc::value > args;
@@ -0,0 +1,224 @@
+/*
+ * (c) 2020, 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cc/widen.hpp>
+
+#include <cc/logger.hpp>
+#include <cc/runtime.hpp>
+
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Transforms/Utils/Local.h>
+
+#include <algorithm>
+#include <string>
+
+namespace lart
+{
+    static bool scalar( llvm::Type *ty )
+    {
+        if ( !ty->isIntegerTy() )
+            return false;
+        auto bw = ty->getIntegerBitWidth();
+        return bw == 8 || bw == 16 || bw == 32 || bw == 64;
+    }
+
+    bool loop_widening::run()
+    {
+        bool changed = false;
+
+        for ( auto &fn : module ) {
+            if ( fn.isDeclaration() || fn.getName().startswith( "__lamp" ) )
+                continue;
+
+            llvm::DominatorTree dt( fn );
+            llvm::LoopInfo li( dt );
+
+            for ( auto loop : li.getLoopsInPreorder() ) {
+                if ( !loop->getLoopPreheader() || !abstract_exit( loop ) )
+                    continue;
+
+                changed |= demote_header_phis( loop );
+                if ( auto vars = loop_carried( loop ); !vars.empty() ) {
+                    widen( loop, vars );
+                    changed = true;
+                }
+            }
+        }
+
+        return changed;
+    }
+
+    bool loop_widening::abstract_exit( llvm::Loop *loop )
+    {
+        llvm::SmallVector< llvm::BasicBlock *, 4 > exiting;
+        loop->getExitingBlocks( exiting );
+
+        return std::any_of( exiting.begin(), exiting.end(), [&] ( auto bb ) {
+            auto br = llvm::dyn_cast< llvm::BranchInst >( bb->getTerminator() );
+            if ( !br || !br->isConditional() )
+                return false;
+            return maybe_abstract( br->getCondition() );
+        } );
+    }
+
+    /* Variables promoted to registers (e.g., by a pre-abstraction pipeline)
+     * are carried by header phis, the runtime widens values in memory, hence
+     * they are demoted back to the stack. Concrete phis, such as counters
+     * compared against an abstract bound, are demoted too, the slot inherits
+     * the type of the phi. */
+    bool loop_widening::demote_header_phis( llvm::Loop *loop )
+    {
+        std::vector< llvm::PHINode * > phis;
+        for ( auto &phi : loop->getHeader()->phis() )
+            if ( scalar( phi.getType() ) )
+                phis.push_back( &phi );
+
+        for ( auto phi : phis ) {
+            auto type = types[ phi ].wrap();
+            types.erase( phi );
+            types.insert_or_assign( llvm::DemotePHIToStack( phi ), type );
+        }
+
+        return !phis.empty();
+    }
+
+    bool loop_widening::maybe_abstract( llvm::Value *val ) const
+    {
+        return types.count( val ) && types.at( val ).maybe_abstract();
+    }
+
+    /* Integer variables that are both read and written in the loop and whose
+     * address does not escape, i.e., they are used only by loads and stores.
+     * Concrete variables are included, a counter that is compared against an
+     * abstract bound stays concrete and the loop terminates only once it is
+     * widened. */
+    std::vector< llvm::AllocaInst * > loop_widening::loop_carried( llvm::Loop *loop )
+    {
+        // widening of an enclosing loop
+        auto widening = [] ( llvm::Value *user ) {
+            auto call = llvm::dyn_cast< llvm::CallInst >( user );
+            auto fn = call ? call->getCalledFunction() : nullptr;
+            return fn && fn->getName().startswith( "__lamp_widen" );
+        };
+
+        auto carried = [&] ( llvm::AllocaInst *var ) {
+            bool loaded = false, stored = false;
+            for ( auto user : var->users() ) {
+                auto inst = llvm::cast< llvm::Instruction >( user );
+                if ( widening( inst ) ) {
+                    continue;
+                } else if ( llvm::isa< llvm::LoadInst >( inst ) ) {
+                    loaded |= loop->contains( inst );
+                } else if ( auto store = llvm::dyn_cast< llvm::StoreInst >( inst ) ) {
+                    if ( store->getValueOperand() == var )
+                        return false;
+                    stored |= loop->contains( inst );
+                } else {
+                    return false;
+                }
+            }
+            return loaded && stored;
+        };
+
+        std::vector< llvm::AllocaInst * > vars;
+        auto &entry = loop->getHeader()->getParent()->getEntryBlock();
+        for ( auto &inst : entry )
+            if ( auto var = llvm::dyn_cast< llvm::AllocaInst >( &inst ) )
+                if ( scalar( var->getAllocatedType() ) && !var->isArrayAllocation() && carried( var ) )
+                    vars.push_back( var );
+        return vars;
+    }
+
+    /* Whether the widened variables are the whole state carried by the loop,
+     * i.e., the loop writes no other memory and no other value is carried by
+     * a header phi. */
+    bool loop_widening::whole_state( llvm::Loop *loop, const std::vector< llvm::AllocaInst * > &vars )
+    {
+        if ( llvm::isa< llvm::PHINode >( loop->getHeader()->front() ) )
+            return false;
+
+        auto widened = [&] ( llvm::Value *ptr ) {
+            return std::find( vars.begin(), vars.end(), ptr->stripPointerCasts() ) != vars.end();
+        };
+
+        for ( auto bb : loop->blocks() ) {
+            for ( auto &inst : *bb ) {
+                if ( auto store = llvm::dyn_cast< llvm::StoreInst >( &inst ) ) {
+                    if ( !widened( store->getPointerOperand() ) )
+                        return false;
+                } else if ( auto call = llvm::dyn_cast< llvm::CallBase >( &inst ) ) {
+                    auto fn = call->getCalledFunction();
+                    // abstract values are created by the domain, not written to memory
+                    if ( fn && fn->getName().startswith( "__lamp_" ) )
+                        continue;
+                    if ( call->mayWriteToMemory() && !call->isLifetimeStartOrEnd() )
+                        return false;
+                } else if ( inst.mayWriteToMemory() ) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /* At the loop header:
+     *
+     *   call @__lamp_widen_enter( site )
+     *   %w = call @__lamp_widen_iN( %var, site )   ; for each variable
+     *   store %w, %var
+     *   call @__lamp_widen_stable( site )
+     *
+     * All variables share the site, the path is cancelled only once all of
+     * them are subsumed by the previous visit. If the loop carries other
+     * state, the values are widened but the stability check is omitted.
+     * The widening state of the site is reset in the preheader, so that each
+     * entry to the loop starts from scratch. */
+    void loop_widening::widen( llvm::Loop *loop, const std::vector< llvm::AllocaInst * > &vars )
+    {
+        runtime::runtime_generator runtime( module );
+
+        auto enter = runtime.register_operation( "widen_enter", sc::void_t(), { sc::i32() } );
+        auto stable = runtime.register_operation( "widen_stable", sc::void_t(), { sc::i32() } );
+        auto reset = runtime.register_operation( "widen_reset", sc::void_t(), { sc::i32() } );
+
+        auto header = loop->getHeader();
+        auto whole = whole_state( loop, vars );
+        auto site = sites++;
+
+        llvm::IRBuilder<> irb( loop->getLoopPreheader()->getTerminator() );
+        irb.CreateCall( reset, { irb.getInt32( site ) } );
+
+        irb.SetInsertPoint( header, header->getFirstInsertionPt() );
+        irb.CreateCall( enter, { irb.getInt32( site ) } );
+
+        for ( auto var : vars ) {
+            spdlog::debug( "[widen] {} at {}", var->getName().str(), header->getName().str() );
+
+            auto ty = var->getAllocatedType();
+            auto name = "i" + std::to_string( ty->getIntegerBitWidth() );
+            auto fn = runtime.register_widen( name, ty );
+
+            auto widened = irb.CreateCall( fn, { var, irb.getInt32( site ) } );
+            irb.CreateStore( widened, var );
+        }
+
+        if ( whole )
+            irb.CreateCall( stable, { irb.getInt32( site ) } );
+    }
+
+} // namespace lart
@@ -1,21 +1,23 @@
-
 #include <lava/support/base.hpp>
 #include <lava/support/scalar.hpp>
 #include <lava/support/reference.hpp>
+#include <lava/support/wrapped_interval.hpp>
 #include <lava/constant.hpp>
 
 #include <lamp/support/semilattice.hpp>
 
+#include <functional>
+#include <optional>
 #include <sstream>
 
 namespace __lava
 {
-    struct bitvec_interval_storage {
-        std::uint64_t left, right;
-        std::uint8_t bw;
-        bool is_signed = false;
-    };
+    using bitvec_interval_storage = sup::wrapped_interval;
 
+    /* Wrapped (modular) intervals of fixed-width bit-vectors. In contrast to
+     * the unbounded interval domain, transfer functions respect bit-widths:
+     * arithmetic wraps around, casts change the width and unsigned and signed
+     * operations are distinguished. */
     template< template< typename > typename storage >
     struct bitvec_interval : storage< bitvec_interval_storage >
                 , domain_mixin< bitvec_interval< storage > >
@@ -28,94 +30,507 @@ namespace __lava
 
         using bvi = bitvec_interval;
         using bitvec_interval_ref = const bitvec_interval &;
+        using ir = bitvec_interval_ref;
+
+        using ref = domain_ref< bitvec_interval >;
+
+        using value_t = bitvec_interval_storage::value_t;
+        using wide_t  = bitvec_interval_storage::wide_t;
+        using uwide_t = bitvec_interval_storage::uwide_t;
+
+        bitvec_interval( const bitvec_interval_storage &i ) : base( i ) {}
+
+        static bvi top( bw w ) { return bitvec_interval_storage::top( w ); }
+
+        template< typename type > static auto lift( const type &v )
+            -> std::enable_if_t< std::is_integral_v< type >, bvi >
+        {
+            return bitvec_interval_storage::constant( value_t( v ), bitwidth_v< type > );
+        }
+
+        template< typename type > static auto lift( const type & )
+            -> std::enable_if_t< !std::is_integral_v< type >, bvi >
+        {
+            return mixin::fail( "non-integral lift" );
+        }
 
-        template< typename type > static bitvec_interval lift( const type& ) { return {}; }
-        template< typename type > static bitvec_interval any() { return {}; }
-        template< typename type > static bitvec_interval any(const variadic_list & /* args */) { return {}; }
-        template< typename type > static bitvec_interval any(type /* from */, type /* to */) { return {}; }
+        template< typename type > static bvi any()
+        {
+            if constexpr ( std::is_integral_v< type > )
+                return top( bitwidth_v< type > );
+            else
+                return mixin::fail( "non-integral any" );
+        }
 
-        template< typename size >
-        static bitvec_interval op_alloca( const size&, uint8_t ) { return {}; }
+        template< typename type > static bvi any( const variadic_list &args )
+        {
+            auto res = bitvec_interval_storage::bottom( bitwidth_v< type > );
+            for ( auto v : args.range< type >() )
+                res = join( res, bitvec_interval_storage::constant( value_t( v ), bitwidth_v< type > ) );
+            return res;
+        }
 
-        static bitvec_interval op_load( bitvec_interval_ref, uint8_t ) { return {}; }
-        static bitvec_interval op_load_at( bitvec_interval_ref, bitvec_interval_ref, uint8_t ) { return {}; }
+        template< typename type > static bvi any( type from, type to )
+        {
+            return bitvec_interval_storage( value_t( from ), value_t( to ), bitwidth_v< type > );
+        }
 
-        template< typename scalar >
-        static void op_store( bitvec_interval_ref, const scalar&, uint8_t ) {}
+        void intersect( const bitvec_interval_storage &other )
+        {
+            this->get() = meet( this->get(), other );
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
 
-        static void assume( bitvec_interval_ref, bool ) {}
+        static void assume( bitvec_interval &i, bool constraint )
+        {
+            auto w = i->bw;
+            if ( constraint )
+                i.intersect( { 1, bitvec_interval_storage::mask( w ), w } );
+            else
+                i.intersect( bitvec_interval_storage::constant( 0, w ) );
+        }
 
-        static tristate to_tristate( bitvec_interval_ref ) { return maybe; }
+        static tristate to_tristate( ir i )
+        {
+            return static_cast< tristate >( i.get() );
+        }
+
+        /* lattice operations */
+        static bvi op_join( ir a, ir b ) { return join( a.get(), b.get() ); }
+        static bvi op_meet( ir a, ir b ) { return meet( a.get(), b.get() ); }
+        static bvi op_widen( ir a, ir b ) { return widen( a.get(), b.get() ); }
+
+        static bool subsumes( ir a, ir b ) { return a->includes( b.get() ); }
+
+        /* Joins the results of an operation on all pairs of pieces. */
+        template< typename pieces_t, typename op_t >
+        static bitvec_interval_storage pairwise( const pieces_t &as, const pieces_t &bs, bw w, op_t op )
+        {
+            auto res = bitvec_interval_storage::bottom( w );
+            for ( const auto &a : as )
+                for ( const auto &b : bs )
+                    res = join( res, op( a, b ) );
+            return res;
+        }
+
+        template< typename op_t >
+        static bitvec_interval_storage unsigned_pairwise( ir a, ir b, op_t op )
+        {
+            return pairwise( a->unsigned_pieces(), b->unsigned_pieces(), a->bw, op );
+        }
+
+        template< typename op_t >
+        static bitvec_interval_storage signed_pairwise( ir a, ir b, op_t op )
+        {
+            return pairwise( a->signed_pieces(), b->signed_pieces(), a->bw, op );
+        }
+
+        static bool undefined( ir a, ir b ) { return a->is_bottom() || b->is_bottom(); }
 
         /* arithmetic operations */
-        static bitvec_interval op_add ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fadd( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_sub ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fsub( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_mul ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fmul( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_udiv( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_sdiv( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fdiv( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_urem( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_srem( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_frem( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-
-        static bitvec_interval op_fneg( bitvec_interval_ref ) { return {}; }
+        static bvi op_add( ir a, ir b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bitvec_interval_storage::bottom( w );
+            if ( a->cardinality() + b->cardinality() - 1 >= bitvec_interval_storage::modulus( w ) )
+                return top( w );
+            return bitvec_interval_storage( a->left + b->left, a->right + b->right, w );
+        }
+
+        static bvi op_sub( ir a, ir b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bitvec_interval_storage::bottom( w );
+            if ( a->cardinality() + b->cardinality() - 1 >= bitvec_interval_storage::modulus( w ) )
+                return top( w );
+            return bitvec_interval_storage( a->left - b->right, a->right - b->left, w );
+        }
+
+        static bvi op_mul( ir a, ir b )
+        {
+            auto w = a->bw;
+            auto umul = unsigned_pairwise( a, b, [w] ( auto x, auto y ) {
+                return bitvec_interval_storage::from_unsigned(
+                    uwide_t( x.first ) * y.first, uwide_t( x.second ) * y.second, w );
+            } );
+
+            auto smul = signed_pairwise( a, b, [w] ( auto x, auto y ) {
+                wide_t corners[] = { x.first * y.first, x.first * y.second,
+                                     x.second * y.first, x.second * y.second };
+                auto [ lo, hi ] = std::minmax_element( std::begin( corners ), std::end( corners ) );
+                return bitvec_interval_storage::from_signed( *lo, *hi, w );
+            } );
+
+            // both are sound, prefer the more precise one
+            return smaller( umul, smul );
+        }
+
+        static bvi op_udiv( ir a, ir b )
+        {
+            auto w = a->bw;
+            auto res = unsigned_pairwise( a, b, [w] ( auto x, auto y ) {
+                if ( y.second == 0 ) // division by zero
+                    return bitvec_interval_storage::bottom( w );
+                auto low = std::max< value_t >( y.first, 1 );
+                return bitvec_interval_storage( x.first / y.second, x.second / low, w );
+            } );
+            return res.is_bottom() && !undefined( a, b ) ? bitvec_interval_storage::top( w ) : res;
+        }
+
+        static bvi op_urem( ir a, ir b )
+        {
+            auto w = a->bw;
+            auto res = unsigned_pairwise( a, b, [w] ( auto x, auto y ) {
+                if ( y.second == 0 )
+                    return bitvec_interval_storage::bottom( w );
+                auto low = std::max< value_t >( y.first, 1 );
+                if ( x.second < low )
+                    return bitvec_interval_storage( x.first, x.second, w );
+                return bitvec_interval_storage( 0, std::min< value_t >( x.second, y.second - 1 ), w );
+            } );
+            return res.is_bottom() && !undefined( a, b ) ? bitvec_interval_storage::top( w ) : res;
+        }
+
+        template< typename op_t >
+        static bitvec_interval_storage signed_division( ir a, ir b, op_t op )
+        {
+            auto w = a->bw;
+            auto as = a->signed_pieces(), bs = b->signed_pieces();
+            auto res = bitvec_interval_storage::bottom( w );
+
+            // split pieces at zero, the division is monotone on parts with
+            // uniform sign, at most two pieces split into at most two parts
+            std::pair< wide_t, wide_t > ap[ 4 ], bp[ 4 ];
+            unsigned an = 0, bn = 0;
+            auto split = [] ( const auto &ps, auto *out, unsigned &n, bool exclude_zero ) {
+                for ( const auto &p : ps ) {
+                    if ( p.first < 0 )
+                        out[ n++ ] = { p.first, std::min< wide_t >( p.second, -1 ) };
+                    auto low = std::max< wide_t >( p.first, exclude_zero ? 1 : 0 );
+                    if ( p.second >= low )
+                        out[ n++ ] = { low, p.second };
+                }
+            };
+
+            split( as, ap, an, false );
+            split( bs, bp, bn, true /* division by zero */ );
+
+            for ( unsigned i = 0; i < an; ++i )
+                for ( unsigned j = 0; j < bn; ++j )
+                    res = join( res, op( ap[ i ], bp[ j ] ) );
+
+            return res.is_bottom() && !undefined( a, b ) ? bitvec_interval_storage::top( w ) : res;
+        }
+
+        static bvi op_sdiv( ir a, ir b )
+        {
+            auto w = a->bw;
+            // extremes of the quotient are in corners
+            return signed_division( a, b, [w] ( auto x, auto y ) {
+                wide_t corners[] = { x.first / y.first, x.first / y.second,
+                                     x.second / y.first, x.second / y.second };
+                auto [ lo, hi ] = std::minmax_element( std::begin( corners ), std::end( corners ) );
+                return bitvec_interval_storage::from_signed( *lo, *hi, w );
+            } );
+        }
+
+        static bvi op_srem( ir a, ir b )
+        {
+            auto w = a->bw;
+            // remainder takes the sign of the dividend and is smaller than the divisor
+            return signed_division( a, b, [w] ( auto x, auto y ) {
+                auto m = std::max( y.first < 0 ? -y.first : y.first, y.second < 0 ? -y.second : y.second ) - 1;
+                if ( x.first >= 0 )
+                    return bitvec_interval_storage::from_signed( 0, std::min( x.second, m ), w );
+                return bitvec_interval_storage::from_signed( std::max( x.first, -m ), 0, w );
+            } );
+        }
 
         /* bitwise operations */
-        static bitvec_interval op_shl ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_lshr( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ashr( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_and ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_or  ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_xor ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
+
+        /* Applies a shift by every possible amount, unless there are too many
+         * of them or some of them is not smaller than the bit-width. */
+        template< typename op_t >
+        static bvi shift( ir a, ir b, op_t op )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bitvec_interval_storage::bottom( w );
+            if ( b->umax() >= w )
+                return top( w );
+
+            auto res = bitvec_interval_storage::bottom( w );
+            for ( auto s = b->umin(); s <= b->umax(); ++s )
+                if ( b->contains( s ) )
+                    res = join( res, op( s ) );
+            return res;
+        }
+
+        static bvi op_shl( ir a, ir b )
+        {
+            return shift( a, b, [&] ( value_t s ) {
+                auto factor = bitvec_interval_storage::constant( value_t( 1 ) << s, a->bw );
+                return op_mul( a, factor ).get();
+            } );
+        }
+
+        static bvi op_lshr( ir a, ir b )
+        {
+            auto w = a->bw;
+            return shift( a, b, [&] ( value_t s ) {
+                auto res = bitvec_interval_storage::bottom( w );
+                for ( const auto &p : a->unsigned_pieces() )
+                    res = join( res, bitvec_interval_storage( p.first >> s, p.second >> s, w ) );
+                return res;
+            } );
+        }
+
+        static bvi op_ashr( ir a, ir b )
+        {
+            auto w = a->bw;
+            return shift( a, b, [&] ( value_t s ) {
+                auto res = bitvec_interval_storage::bottom( w );
+                for ( const auto &p : a->signed_pieces() )
+                    res = join( res, bitvec_interval_storage::from_signed( p.first >> s, p.second >> s, w ) );
+                return res;
+            } );
+        }
+
+        /* Smallest value of the form 2^k - 1 not smaller than v. */
+        static value_t ones( value_t v )
+        {
+            return v == 0 ? 0 : ~value_t( 0 ) >> __builtin_clzll( v );
+        }
+
+        template< typename fn_t, typename bound_t >
+        static bvi bitwise( ir a, ir b, fn_t fn, bound_t bound )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bitvec_interval_storage::bottom( w );
+            if ( a->is_constant() && b->is_constant() )
+                return bitvec_interval_storage::constant( fn( a->left, b->left ), w );
+            return unsigned_pairwise( a, b, [&] ( auto x, auto y ) {
+                auto [ lo, hi ] = bound( x, y );
+                return bitvec_interval_storage( lo, hi, w );
+            } );
+        }
+
+        static bvi op_and( ir a, ir b )
+        {
+            return bitwise( a, b, std::bit_and(), [] ( auto x, auto y ) {
+                return std::pair< value_t, value_t >( 0, std::min( x.second, y.second ) );
+            } );
+        }
+
+        static bvi op_or( ir a, ir b )
+        {
+            return bitwise( a, b, std::bit_or(), [] ( auto x, auto y ) {
+                return std::pair( std::max( x.first, y.first ), ones( std::max( x.second, y.second ) ) );
+            } );
+        }
+
+        static bvi op_xor( ir a, ir b )
+        {
+            return bitwise( a, b, std::bit_xor(), [] ( auto x, auto y ) {
+                return std::pair< value_t, value_t >( 0, ones( std::max( x.second, y.second ) ) );
+            } );
+        }
 
         /* comparison operations */
-        static bitvec_interval op_foeq( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fogt( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_foge( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_folt( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fole( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fone( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ford( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_funo( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fueq( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fugt( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fuge( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fult( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fule( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_fune( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-
-        static bitvec_interval op_eq ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ne ( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ugt( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_uge( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ult( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ule( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_sgt( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_sge( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_slt( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_sle( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-
-        static bitvec_interval op_ffalse( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-        static bitvec_interval op_ftrue( bitvec_interval_ref, bitvec_interval_ref ) { return {}; }
-
-
-        static bitvec_interval op_fpext( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_fptosi( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_fptoui( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_fptrunc( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_inttoptr( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_ptrtoint( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_sext( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_sitofp( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_trunc( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_uitofp( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_zext( bitvec_interval_ref, bw ) { return {}; }
-        static bitvec_interval op_zfit( bitvec_interval_ref, bw ) { return {}; }
-
-        static std::string trace( bitvec_interval_ref ) { return "bitvec_interval"; }
+        static bvi compare( bool definitely, bool definitely_not )
+        {
+            if ( definitely )
+                return bitvec_interval_storage::from_bool( true );
+            if ( definitely_not )
+                return bitvec_interval_storage::from_bool( false );
+            return top( 1 );
+        }
+
+        static bvi op_eq( ir a, ir b )
+        {
+            if ( undefined( a, b ) )
+                return bitvec_interval_storage::bottom( 1 );
+            bool same = a->is_constant() && b->is_constant() && a->left == b->left;
+            return compare( same, meet( a.get(), b.get() ).is_bottom() );
+        }
+
+        static bvi op_ne( ir a, ir b )
+        {
+            return bitvec_interval_storage::from_tristate( !to_tristate( op_eq( a, b ) ) );
+        }
+
+        static bvi op_ult( ir a, ir b ) { return compare( a->umax() <  b->umin(), a->umin() >= b->umax() ); }
+        static bvi op_ule( ir a, ir b ) { return compare( a->umax() <= b->umin(), a->umin() >  b->umax() ); }
+        static bvi op_ugt( ir a, ir b ) { return op_ult( b, a ); }
+        static bvi op_uge( ir a, ir b ) { return op_ule( b, a ); }
+
+        static bvi op_slt( ir a, ir b ) { return compare( a->smax() <  b->smin(), a->smin() >= b->smax() ); }
+        static bvi op_sle( ir a, ir b ) { return compare( a->smax() <= b->smin(), a->smin() >  b->smax() ); }
+        static bvi op_sgt( ir a, ir b ) { return op_slt( b, a ); }
+        static bvi op_sge( ir a, ir b ) { return op_sle( b, a ); }
+
+        /* cast operations */
+        static bvi op_trunc( ir i, bw w )
+        {
+            if ( i->is_bottom() )
+                return bitvec_interval_storage::bottom( w );
+            // consecutive values stay consecutive modulo 2^w
+            if ( i->cardinality() >= bitvec_interval_storage::modulus( w ) )
+                return top( w );
+            return bitvec_interval_storage( i->left, i->right, w );
+        }
+
+        static bvi op_zext( ir i, bw w )
+        {
+            auto res = bitvec_interval_storage::bottom( w );
+            for ( const auto &p : i->unsigned_pieces() )
+                res = join( res, bitvec_interval_storage( p.first, p.second, w ) );
+            return res;
+        }
+
+        static bvi op_sext( ir i, bw w )
+        {
+            auto res = bitvec_interval_storage::bottom( w );
+            for ( const auto &p : i->signed_pieces() )
+                res = join( res, bitvec_interval_storage::from_signed( p.first, p.second, w ) );
+            return res;
+        }
+
+        static bvi op_zfit( ir i, bw w )
+        {
+            return w < i->bw ? op_trunc( i, w ) : op_zext( i, w );
+        }
+
+        static bvi op_concat( ir a, ir b )
+        {
+            auto w = bw( a->bw + b->bw );
+            if ( a->is_constant() && b->is_constant() )
+                return bitvec_interval_storage::constant( ( a->left << b->bw ) | b->left, w );
+            return top( w );
+        }
+
+        /* backward operations */
+        static void bop_add( ir r, ref a, ref b )
+        {
+            a.intersect( op_sub( r, b ).get() );
+            b.intersect( op_sub( r, a ).get() );
+        }
+
+        static void bop_sub( ir r, ref a, ref b )
+        {
+            a.intersect( op_add( r, b ).get() );
+            b.intersect( op_sub( a, r ).get() );
+        }
+
+        static void bop_trunc( ir, ir ) {}
+
+        static void bop_zext( ir r, ref a ) { a.intersect( op_trunc( r, a->bw ).get() ); }
+        static void bop_sext( ir r, ref a ) { a.intersect( op_trunc( r, a->bw ).get() ); }
+        static void bop_zfit( ir r, ref a )
+        {
+            if ( a->bw < r->bw )
+                a.intersect( op_trunc( r, a->bw ).get() );
+        }
+
+        /* Outcome of a comparison, if it is known. */
+        static std::optional< bool > outcome( ir r )
+        {
+            if ( !r->is_constant() )
+                return std::nullopt;
+            return r->left != 0;
+        }
+
+        static void beq( ir r, ref a, ref b, bool negated = false )
+        {
+            auto res = outcome( r );
+            if ( !res )
+                return;
+
+            if ( *res != negated ) {
+                a.intersect( b.get() );
+                b.intersect( a.get() );
+                return;
+            }
+
+            // exclude a constant from the bounds of the other operand
+            auto exclude = [] ( ref x, ir c ) {
+                if ( !c->is_constant() || x->is_top() )
+                    return;
+                if ( x->left == c->left )
+                    x.intersect( { x->left + 1, x->right, x->bw } );
+                else if ( x->right == c->left )
+                    x.intersect( { x->left, x->right - 1, x->bw } );
+            };
+
+            if ( a->is_constant() && b->is_constant() && a->left == b->left )
+                __lart_cancel();
+            exclude( a, b );
+            exclude( b, a );
+        }
+
+        /* Refines a < b (or a <= b if not strict) in unsigned order. */
+        static void bult( ref a, ref b, bool strict )
+        {
+            auto w = a->bw;
+            auto max = bitvec_interval_storage::mask( w );
+            value_t d = strict ? 1 : 0;
+            if ( b->umax() < d || a->umin() > max - d )
+                __lart_cancel();
+            a.intersect( { 0, b->umax() - d, w } );
+            b.intersect( { a->umin() + d, max, w } );
+        }
+
+        /* Refines a < b (or a <= b if not strict) in signed order. */
+        static void bslt( ref a, ref b, bool strict )
+        {
+            auto w = a->bw;
+            auto min = a->to_signed( a->smin_value() ), max = a->to_signed( a->smax_value() );
+            wide_t d = strict ? 1 : 0;
+            if ( b->smax() - d < min || a->smin() + d > max )
+                __lart_cancel();
+            a.intersect( bitvec_interval_storage::from_signed( min, b->smax() - d, w ) );
+            b.intersect( bitvec_interval_storage::from_signed( a->smin() + d, max, w ) );
+        }
+
+        template< typename refine_t >
+        static void blt( ir r, ref a, ref b, refine_t refine )
+        {
+            if ( auto res = outcome( r ) ) {
+                if ( *res )
+                    refine( a, b, true );
+                else
+                    refine( b, a, false );
+            }
+        }
+
+        static void bop_eq( ir r, ir a, ir b ) { beq( r, a, b ); }
+        static void bop_ne( ir r, ir a, ir b ) { beq( r, a, b, true /* negated */ ); }
+
+        static void bop_ult( ir r, ir a, ir b ) { blt( r, a, b, bult ); }
+        static void bop_ugt( ir r, ir a, ir b ) { blt( r, b, a, bult ); }
+        static void bop_ule( ir r, ir a, ir b ) { blt( r, b, a, [] ( ref x, ref y, bool strict ) { bult( y, x, !strict ); } ); }
+        static void bop_uge( ir r, ir a, ir b ) { bop_ule( r, b, a ); }
+
+        static void bop_slt( ir r, ir a, ir b ) { blt( r, a, b, bslt ); }
+        static void bop_sgt( ir r, ir a, ir b ) { blt( r, b, a, bslt ); }
+        static void bop_sle( ir r, ir a, ir b ) { blt( r, b, a, [] ( ref x, ref y, bool strict ) { bslt( y, x, !strict ); } ); }
+        static void bop_sge( ir r, ir a, ir b ) { bop_sle( r, b, a ); }
+
+        static std::string trace( ir i )
+        {
+            if ( i->is_bottom() )
+                return "bottom";
+            if ( i->is_top() )
+                return "top:" + std::to_string( i->bw );
+
+            std::stringstream ss;
+            ss << '[' << i->left << ", " << i->right << "]:" << unsigned( i->bw );
+            return ss.str();
+        }
 
         template< typename stream >
         friend stream& operator<<( stream &os, bitvec_interval_ref i ) { return os << trace( i ); }
@@ -0,0 +1,281 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/constant.hpp>
+#include <lava/term.hpp>
+#include <lava/support/product.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace __lava
+{
+    /* Input of a single run: values of `any` variables by the suffix of their
+     * `var_N` names (missing ones are zero) and the number of leading branches
+     * whose alternatives were already scheduled by the run that produced it. */
+    struct concolic_input
+    {
+        std::map< uint64_t, uint64_t > values;
+        uint64_t bound = 0;
+    };
+
+    /* Branch decided by the concrete values of the run, the alternative is
+     * the flipped condition under the first `prefix` constraints of the path
+     * condition. */
+    struct concolic_alternative
+    {
+        uint64_t branch;
+        size_t prefix;
+        z3::expr flipped;
+    };
+
+    /* The process that reaches the first `any` drives the exploration: it
+     * forks a run for each input and the run sends back inputs for the
+     * alternatives of its branches when it exits. A run follows its concrete
+     * values, hence it needs no solver and does not fork on its way. */
+    struct concolic_state_t
+    {
+        concolic_input input;
+        std::vector< concolic_alternative > alternatives;
+        uint64_t branches = 0;
+        int channel = -1; // write end of the pipe to the driver
+        bool driven = false;
+    };
+
+    std::unique_ptr< concolic_state_t > __concolic_state;
+
+    inline void concolic_send( int fd, const concolic_input &input )
+    {
+        std::vector< uint64_t > record{ input.bound, input.values.size() };
+        for ( auto [ var, value ] : input.values ) {
+            record.push_back( var );
+            record.push_back( value );
+        }
+
+        auto data = reinterpret_cast< const char * >( record.data() );
+        auto size = record.size() * sizeof( uint64_t );
+        while ( size ) {
+            auto written = write( fd, data, size );
+            if ( written < 0 )
+                return;
+            data += written;
+            size -= size_t( written );
+        }
+    }
+
+    inline void concolic_receive( int fd, std::vector< concolic_input > &inputs )
+    {
+        std::vector< uint64_t > data;
+        uint64_t buffer[ 512 ];
+        ssize_t size;
+        while ( ( size = read( fd, buffer, sizeof( buffer ) ) ) > 0 )
+            data.insert( data.end(), buffer, buffer + size / ssize_t( sizeof( uint64_t ) ) );
+
+        for ( size_t i = 0; i + 2 <= data.size(); ) {
+            concolic_input input;
+            input.bound = data[ i++ ];
+            auto count = data[ i++ ];
+            for ( ; count && i + 2 <= data.size(); --count, i += 2 )
+                input.values[ data[ i ] ] = data[ i + 1 ];
+            inputs.push_back( std::move( input ) );
+        }
+    }
+
+    /* Runs at the exit of a run. Alternatives are decided in the order of
+     * their branches against a path condition that grows by the prefixes,
+     * so that each query is sliced as in the term domain. */
+    inline void concolic_flip()
+    {
+        auto &state = *__concolic_state;
+        auto &term = *__term_state;
+        const auto &constraints = term.path.constraints();
+
+        path_condition prefix( term.ctx );
+        prefix.limits( term.limits );
+        prefix.cache( __term_cache.get() );
+
+        size_t added = 0;
+        for ( const auto &alt : state.alternatives ) {
+            for ( ; added < alt.prefix; ++added )
+                prefix.add( constraints[ added ].expr );
+
+            auto result = prefix.witness( alt.flipped );
+            if ( result == z3::unsat )
+                continue;
+            if ( result == z3::unknown || !prefix.model() ) {
+                ++__term_stats->unknown;
+                continue;
+            }
+
+            z3::model witness( term.ctx );
+            prefix.update( witness, alt.flipped );
+
+            concolic_input next{ state.input.values, alt.branch + 1 };
+            for ( unsigned i = 0; i < witness.num_consts(); ++i ) {
+                auto decl = witness.get_const_decl( i );
+                auto value = witness.get_const_interp( decl );
+                uint64_t numeral;
+                if ( value.is_bv() && value.is_numeral_u64( numeral ) )
+                    next.values[ path_condition::variable_id( decl() ) ] = numeral;
+            }
+
+            concolic_send( state.channel, next );
+        }
+    }
+
+    /* Forks a run for each input, starting with the all-zero one, most
+     * recently generated inputs first. Returns only in the runs. */
+    inline void concolic_drive()
+    {
+        auto &state = *__concolic_state;
+        std::vector< concolic_input > inputs( 1 );
+
+        while ( !inputs.empty() && !__lart::rt::config->error_found ) {
+            int channel[ 2 ];
+            if ( pipe( channel ) != 0 ) {
+                perror( "[concolic] pipe" );
+                std::exit( EXIT_FAILURE );
+            }
+
+            auto input = std::move( inputs.back() );
+            inputs.pop_back();
+
+            if ( fork() == 0 ) {
+                close( channel[ 0 ] );
+                state.input = std::move( input );
+                state.channel = channel[ 1 ];
+                // registered after static initialization, hence it runs
+                // before the solver state is destroyed
+                std::atexit( concolic_flip );
+                return;
+            }
+
+            close( channel[ 1 ] );
+            concolic_receive( channel[ 0 ], inputs );
+            close( channel[ 0 ] );
+
+            int status;
+            wait( &status );
+            if ( !WIFEXITED( status ) )
+                std::exit( EXIT_FAILURE );
+            if ( WEXITSTATUS( status ) != 0 )
+                std::exit( WEXITSTATUS( status ) );
+        }
+
+        std::exit( EXIT_SUCCESS );
+    }
+
+    using concolic_config = product_config< lower_first, to_tristate_disabled >;
+
+    /* Concrete shadow alongside symbolic terms. Branches are decided by the
+     * concrete values, the flipped alternatives are explored by later runs
+     * with inputs that the solver finds for them. */
+    template< template< typename > typename storage >
+    struct concolic : product< constant< storage >, term< storage >, storage, concolic_config >
+    {
+        using concrete = constant< storage >;
+        using symbolic = term< storage >;
+
+        using base = product< concrete, symbolic, storage, concolic_config >;
+        using base::base;
+
+        using pr = const base &;
+
+        template< typename type > static base any()
+        {
+            auto &state = *__concolic_state;
+            if ( !state.driven ) {
+                state.driven = true;
+                concolic_drive();
+            }
+
+            auto var = symbolic::template any< type >();
+            type value{};
+            if constexpr ( std::is_integral_v< type > ) {
+                auto id = path_condition::variable_id( var.get() );
+                if ( auto it = state.input.values.find( id ); it != state.input.values.end() )
+                    value = type( it->second );
+            }
+
+            return { concrete::lift( value ), std::move( var ) };
+        }
+
+        template< typename type > static base any( const variadic_list & )
+        {
+            return base::mixin::fail( "unsupported variadic any operation" );
+        }
+
+        template< typename type > static base any( type, type )
+        {
+            return base::mixin::fail( "unsupported range any operation" );
+        }
+
+        static z3::expr condition( pr v )
+        {
+            const auto &e = v->second.get();
+            return e.is_bool() ? e : symbolic::tobool( e );
+        }
+
+        static bool value( pr v )
+        {
+            return concrete::to_tristate( v->first ).value == tristate::true_value;
+        }
+
+        /* Records the flipped alternative of a non-constant condition, unless
+         * the run that produced the input has already done so. */
+        static tristate to_tristate( pr v )
+        {
+            ++__term_stats->forks_avoided;
+
+            auto b = condition( v );
+            if ( b.is_true() || b.is_false() )
+                return tristate( b.is_true() );
+
+            auto &state = *__concolic_state;
+            auto taken = value( v );
+            if ( auto branch = state.branches++; branch >= state.input.bound ) {
+                auto prefix = __term_state->path.constraints().size();
+                state.alternatives.push_back( { branch, prefix, taken ? !b : b } );
+            }
+
+            return tristate( taken );
+        }
+
+        /* The assignment witnesses the branch, no need to ask the solver. */
+        static void assume( base &v, bool expected )
+        {
+            if ( value( v ) != expected )
+                __lart_cancel();
+
+            auto b = condition( v );
+            symbolic::constrain( expected ? b : !b );
+        }
+    };
+
+    [[gnu::constructor( 102 )]] void concolic_setup()
+    {
+        __concolic_state = std::make_unique< concolic_state_t >();
+    }
+
+} // namespace __lava
@@ -0,0 +1,352 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/base.hpp>
+#include <lava/support/scalar.hpp>
+#include <lava/support/reference.hpp>
+#include <lava/support/congruence.hpp>
+
+#include <optional>
+#include <string>
+
+namespace __lava
+{
+    using congruence_storage = sup::congruence;
+
+    /* Congruence domain tracks values of the form a * k + b, e.g., offsets
+     * of strided accesses. It ignores bitwidth like the interval domain. */
+    template< template< typename > typename storage >
+    struct congruence : storage< congruence_storage >
+                      , domain_mixin< congruence< storage > >
+    {
+        using base = storage< congruence_storage >;
+        using mixin = domain_mixin< congruence >;
+
+        using bw = typename mixin::bw;
+        using base::base;
+
+        using cv = congruence;
+        using cr = const congruence &;
+
+        using ref = domain_ref< congruence >;
+
+        using value_t = congruence_storage::value_t;
+        using stride_t = congruence_storage::stride_t;
+
+        congruence( const congruence_storage &v ) : base( v ) {}
+
+        static cv top() { return congruence_storage::top(); }
+        static cv constant( value_t v ) { return congruence_storage::constant( v ); }
+
+        template< typename type > static auto lift( const type &v )
+            -> std::enable_if_t< std::is_integral_v< type >, cv >
+        {
+            return constant( value_t( v ) );
+        }
+
+        template< typename type > static auto lift( const type & )
+            -> std::enable_if_t< !std::is_integral_v< type >, cv >
+        {
+            return mixin::fail( "non-integral lift" );
+        }
+
+        template< typename type > static cv any()
+        {
+            if constexpr ( std::is_integral_v< type > )
+                return top();
+            else
+                return mixin::fail( "non-integral any" );
+        }
+
+        template< typename type > static cv any( const variadic_list &args )
+        {
+            auto res = congruence_storage::bottom();
+            for ( auto v : args.range< type >() )
+                res = join( res, congruence_storage::constant( value_t( v ) ) );
+            return res;
+        }
+
+        template< typename type > static cv any( type from, type to )
+        {
+            return from == to ? constant( value_t( from ) ) : top();
+        }
+
+        void intersect( const congruence_storage &other )
+        {
+            this->get() = meet( this->get(), other );
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
+
+        static void assume( congruence &v, bool constraint )
+        {
+            if ( !constraint )
+                return v.intersect( congruence_storage::constant( 0 ) );
+            if ( v->is_constant() && v->offset == 0 )
+                __lart_cancel();
+        }
+
+        static tristate to_tristate( cr v )
+        {
+            return static_cast< tristate >( v.get() );
+        }
+
+        /* lattice operations, strides form chains of divisors */
+        static cv op_join( cr a, cr b ) { return join( a.get(), b.get() ); }
+        static cv op_meet( cr a, cr b ) { return meet( a.get(), b.get() ); }
+
+        static bool subsumes( cr a, cr b ) { return a->includes( b.get() ); }
+
+        /* arithmetic operations */
+        static cv op_add( cr a, cr b ) { return a.get() + b.get(); }
+        static cv op_sub( cr a, cr b ) { return a.get() - b.get(); }
+        static cv op_mul( cr a, cr b ) { return a.get() * b.get(); }
+
+        static std::optional< value_t > divisor( cr b )
+        {
+            if ( b->is_constant() && b->offset != 0 )
+                return b->offset;
+            return std::nullopt;
+        }
+
+        /* Division is exact if the divisor divides all values. */
+        static cv op_sdiv( cr a, cr b )
+        {
+            auto d = divisor( b );
+            if ( !d )
+                return top();
+            if ( a->is_constant() )
+                return constant( a->offset / *d );
+            if ( a->stride % stride_t( std::abs( *d ) ) == 0 && a->offset % *d == 0 )
+                return congruence_storage::make( congruence_storage::wide_t( a->stride ) / *d, a->offset / *d );
+            return top();
+        }
+
+        /* The domain ignores bitwidth, so the unsigned value of a possibly
+         * negative one is unknown. Unsigned operations are decided only on
+         * nonnegative constants, where they agree with the signed ones. */
+        static bool nonnegative( cr a ) { return a->is_constant() && a->offset >= 0; }
+
+        static cv op_udiv( cr a, cr b )
+        {
+            if ( nonnegative( a ) && nonnegative( b ) && b->offset != 0 )
+                return constant( a->offset / b->offset );
+            return top();
+        }
+
+        /* a % d is congruent to a modulo d */
+        static cv op_srem( cr a, cr b )
+        {
+            auto d = divisor( b );
+            if ( !d )
+                return top();
+            if ( a->is_constant() )
+                return constant( a->offset % *d );
+            auto res = congruence_storage::make( congruence_storage::gcd( a->stride, *d ), a->offset );
+            // a % d lies between -|d| and |d|, so a zero residue modulo |d| is zero
+            if ( res.stride == stride_t( std::abs( *d ) ) && res.offset == 0 )
+                return constant( 0 );
+            return res;
+        }
+
+        /* Modulo a power of two, which divides the size of the unsigned range,
+         * the unsigned value is congruent to the signed one and the remainder
+         * is the nonnegative residue. */
+        static cv op_urem( cr a, cr b )
+        {
+            if ( a->is_bottom() )
+                return a.get();
+            if ( nonnegative( a ) && nonnegative( b ) && b->offset != 0 )
+                return constant( a->offset % b->offset );
+
+            auto d = divisor( b );
+            if ( !d || *d < 0 || ( *d & ( *d - 1 ) ) != 0 )
+                return top();
+
+            auto res = congruence_storage::make( congruence_storage::gcd( a->stride, *d ), a->offset );
+            if ( res.stride == stride_t( *d ) )
+                return constant( res.offset );
+            return res;
+        }
+
+        /* bitwise operations */
+        static cv op_shl( cr a, cr b )
+        {
+            if ( !b->is_constant() || b->offset < 0 || b->offset >= 63 )
+                return top();
+            return a.get() * congruence_storage::constant( value_t( 1 ) << b->offset );
+        }
+
+        static cv op_ashr( cr a, cr b )
+        {
+            if ( a->is_constant() && b->is_constant() && b->offset >= 0 && b->offset < 64 )
+                return constant( a->offset >> b->offset );
+            return top();
+        }
+
+        static cv op_lshr( cr a, cr b )
+        {
+            if ( nonnegative( a ) && nonnegative( b ) && b->offset < 64 )
+                return constant( a->offset >> b->offset );
+            return top();
+        }
+
+        /* Low bits of all values agree below the lowest set bit of the stride. */
+        static cv op_and( cr a, cr b )
+        {
+            if ( a->is_constant() && b->is_constant() )
+                return constant( a->offset & b->offset );
+            if ( b->is_constant() && b->offset >= 0 && a->stride != 0 ) {
+                auto low = stride_t( 1 ) << __builtin_ctzll( a->stride );
+                if ( stride_t( b->offset ) < low )
+                    return constant( a->offset & b->offset );
+            }
+            if ( a->is_constant() )
+                return op_and( b, a );
+            return top();
+        }
+
+        static cv op_or( cr a, cr b )
+        {
+            if ( a->is_constant() && b->is_constant() )
+                return constant( a->offset | b->offset );
+            return top();
+        }
+
+        static cv op_xor( cr a, cr b )
+        {
+            if ( a->is_constant() && b->is_constant() )
+                return constant( a->offset ^ b->offset );
+            return top();
+        }
+
+        /* comparison operations */
+        static cv compare( tristate t ) { return congruence_storage::from_tristate( t ); }
+
+        static tristate constants( cr a, cr b, bool ( *cmp )( value_t, value_t ) )
+        {
+            if ( a->is_constant() && b->is_constant() )
+                return tristate( cmp( a->offset, b->offset ) );
+            return maybe;
+        }
+
+        static cv op_eq( cr a, cr b )
+        {
+            if ( meet( a.get(), b.get() ).is_bottom() )
+                return compare( tristate( false ) );
+            return compare( constants( a, b, [] ( value_t x, value_t y ) { return x == y; } ) );
+        }
+
+        static cv op_ne( cr a, cr b )
+        {
+            return compare( !to_tristate( op_eq( a, b ) ) );
+        }
+
+        static cv op_slt( cr a, cr b ) { return compare( constants( a, b, [] ( value_t x, value_t y ) { return x < y; } ) ); }
+        static cv op_sle( cr a, cr b ) { return compare( constants( a, b, [] ( value_t x, value_t y ) { return x <= y; } ) ); }
+        static cv op_sgt( cr a, cr b ) { return op_slt( b, a ); }
+        static cv op_sge( cr a, cr b ) { return op_sle( b, a ); }
+
+        static cv unsigned_compare( cr a, cr b, bool ( *cmp )( value_t, value_t ) )
+        {
+            if ( nonnegative( a ) && nonnegative( b ) )
+                return compare( constants( a, b, cmp ) );
+            return compare( maybe );
+        }
+
+        static cv op_ult( cr a, cr b ) { return unsigned_compare( a, b, [] ( value_t x, value_t y ) { return x < y; } ); }
+        static cv op_ule( cr a, cr b ) { return unsigned_compare( a, b, [] ( value_t x, value_t y ) { return x <= y; } ); }
+        static cv op_ugt( cr a, cr b ) { return op_ult( b, a ); }
+        static cv op_uge( cr a, cr b ) { return op_ule( b, a ); }
+
+        // unbounded congruences ignore bitwidth
+        static cv op_sext ( cr a, bw ) { return a.get(); }
+        static cv op_trunc( cr a, bw ) { return a.get(); }
+        static cv op_zext ( cr a, bw ) { return a.get(); }
+        static cv op_zfit ( cr a, bw ) { return a.get(); }
+
+        /* backward operations */
+        static void bop_add( cr r, ref a, ref b )
+        {
+            a.intersect( op_sub( r, b ).get() );
+            b.intersect( op_sub( r, a ).get() );
+        }
+
+        static void bop_sub( cr r, ref a, ref b )
+        {
+            a.intersect( op_add( r, b ).get() );
+            b.intersect( op_sub( a, r ).get() );
+        }
+
+        static void bop_mul( cr, cr, cr ) {}
+        static void bop_sdiv( cr, cr, cr ) {}
+        static void bop_udiv( cr, cr, cr ) {}
+        static void bop_srem( cr, cr, cr ) {}
+        static void bop_urem( cr, cr, cr ) {}
+
+        static void bop_shl ( cr, cr, cr ) {}
+        static void bop_ashr( cr, cr, cr ) {}
+        static void bop_lshr( cr, cr, cr ) {}
+        static void bop_and ( cr, cr, cr ) {}
+        static void bop_or  ( cr, cr, cr ) {}
+        static void bop_xor ( cr, cr, cr ) {}
+
+        static void bop_trunc( cr r, ref a ) { a.intersect( r.get() ); }
+        static void bop_zext ( cr r, ref a ) { a.intersect( r.get() ); }
+        static void bop_sext ( cr r, ref a ) { a.intersect( r.get() ); }
+        static void bop_zfit ( cr r, ref a ) { a.intersect( r.get() ); }
+
+        static void beq( cr r, ref a, ref b, bool negated = false )
+        {
+            if ( !r->is_constant() )
+                return;
+
+            if ( ( r->offset != 0 ) != negated ) {
+                a.intersect( b.get() );
+                b.intersect( a.get() );
+            } else if ( a->is_constant() && b->is_constant() && a->offset == b->offset ) {
+                __lart_cancel();
+            }
+        }
+
+        static void bop_eq( cr r, cr a, cr b ) { beq( r, a, b ); }
+        static void bop_ne( cr r, cr a, cr b ) { beq( r, a, b, true /* negated */ ); }
+
+        // orderings do not refine congruences
+        static void bop_ult( cr, cr, cr ) {}
+        static void bop_ugt( cr, cr, cr ) {}
+        static void bop_ule( cr, cr, cr ) {}
+        static void bop_uge( cr, cr, cr ) {}
+        static void bop_slt( cr, cr, cr ) {}
+        static void bop_sgt( cr, cr, cr ) {}
+        static void bop_sle( cr, cr, cr ) {}
+        static void bop_sge( cr, cr, cr ) {}
+
+        static std::string trace( cr v )
+        {
+            if ( v->is_bottom() )
+                return "bottom";
+            if ( v->is_constant() )
+                return std::to_string( v->offset );
+            return std::to_string( v->stride ) + "ℤ + " + std::to_string( v->offset );
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, cr v ) { return os << trace( v ); }
+    };
+} // namespace __lava
@@ -0,0 +1,443 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/base.hpp>
+#include <lava/support/scalar.hpp>
+#include <lava/support/reference.hpp>
+#include <lava/support/tristate.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace __lava
+{
+    /* Bounds of the non-NaN values (infinities included) and whether the
+     * value may be NaN. A value that is only NaN has empty bounds. */
+    struct float_interval_storage
+    {
+        static constexpr double inf = std::numeric_limits< double >::infinity();
+
+        double low = -inf, high = inf;
+        bool nan = true;
+        bitwidth_t bw = 64;
+
+        constexpr bool empty() const { return !( low <= high ); }
+        constexpr bool is_bottom() const { return empty() && !nan; }
+        constexpr bool is_constant() const { return low == high && !nan; }
+    };
+
+    /* Float interval domain. Rounding to nearest is monotone, hence bounds
+     * evaluated in the precision of the operation enclose every concrete
+     * result; backward refinement of strict comparisons rounds outward to
+     * the neighbouring float. Values that result from comparisons are
+     * booleans, intervals of width one. */
+    template< template< typename > typename storage >
+    struct float_interval : storage< float_interval_storage >
+                          , domain_mixin< float_interval< storage > >
+    {
+        using base = storage< float_interval_storage >;
+        using mixin = domain_mixin< float_interval >;
+
+        using bw = typename mixin::bw;
+        using base::base;
+
+        using fv = float_interval;
+        using fr = const float_interval &;
+
+        using ref = domain_ref< float_interval >;
+
+        static constexpr double inf = float_interval_storage::inf;
+
+        float_interval( const float_interval_storage &v ) : base( v ) {}
+
+        static fv make( double low, double high, bool nan, bw w ) { return float_interval_storage{ low, high, nan, w }; }
+        static fv top( bw w ) { return make( -inf, inf, true, w ); }
+        static fv only_nan( bw w ) { return make( inf, -inf, true, w ); }
+
+        static fv boolean( tristate t )
+        {
+            if ( maybe( t ) )
+                return make( 0, 1, false, 1 );
+            return make( bool( t ), bool( t ), false, 1 );
+        }
+
+        /* rounds to the precision of the value */
+        static double round( double v, bw w ) { return w == 32 ? double( float( v ) ) : v; }
+
+        /* the neighbouring float in the direction of `to` */
+        static double next( double v, double to, bw w )
+        {
+            return w == 32 ? double( std::nextafter( float( v ), float( to ) ) ) : std::nextafter( v, to );
+        }
+
+        template< typename type > static fv lift( const type &v )
+        {
+            if constexpr ( std::is_floating_point_v< type > ) {
+                if ( std::isnan( v ) )
+                    return only_nan( bitwidth_v< type > );
+                return make( v, v, false, bitwidth_v< type > );
+            }
+            else if constexpr ( std::is_integral_v< type > )
+                return make( double( v ), double( v ), false, bitwidth_v< type > );
+            else
+                return mixin::fail( "unsupported lift" );
+        }
+
+        template< typename type > static fv any() { return top( bitwidth_v< type > ); }
+
+        template< typename type > static fv any( const variadic_list & )
+        {
+            return mixin::fail( "unsupported variadic any operation" );
+        }
+
+        template< typename type > static fv any( type from, type to )
+        {
+            return make( double( from ), double( to ), false, bitwidth_v< type > );
+        }
+
+        void intersect( double low, double high )
+        {
+            auto &v = this->get();
+            v.low = std::max( v.low, low );
+            v.high = std::min( v.high, high );
+            if ( v.is_bottom() )
+                __lart_cancel();
+        }
+
+        void exclude_nan()
+        {
+            this->get().nan = false;
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
+
+        static void assume( float_interval &v, bool constraint )
+        {
+            if ( !constraint )
+                return v.intersect( 0, 0 );
+            if ( v->bw == 1 )
+                return v.intersect( 1, 1 );
+            if ( v->low == 0 )
+                v.intersect( next( 0, inf, v->bw ), inf );
+            if ( v->high == 0 )
+                v.intersect( -inf, next( 0, -inf, v->bw ) );
+        }
+
+        static tristate to_tristate( fr v )
+        {
+            if ( v->is_constant() )
+                return tristate( v->low != 0 );
+            if ( !v->nan && ( v->low > 0 || v->high < 0 ) )
+                return tristate( true );
+            return maybe;
+        }
+
+        /* lattice operations */
+        static fv op_join( fr a, fr b )
+        {
+            if ( a->empty() )
+                return make( b->low, b->high, a->nan || b->nan, b->bw );
+            if ( b->empty() )
+                return make( a->low, a->high, a->nan || b->nan, a->bw );
+            return make( std::min( a->low, b->low ), std::max( a->high, b->high ), a->nan || b->nan, a->bw );
+        }
+
+        static fv op_meet( fr a, fr b )
+        {
+            return make( std::max( a->low, b->low ), std::min( a->high, b->high ), a->nan && b->nan, a->bw );
+        }
+
+        static fv op_widen( fr a, fr b )
+        {
+            auto j = op_join( a, b );
+            if ( a->empty() )
+                return j;
+            return make( j->low < a->low ? -inf : a->low, j->high > a->high ? inf : a->high, j->nan, a->bw );
+        }
+
+        static bool subsumes( fr a, fr b )
+        {
+            return ( a->nan || !b->nan ) && ( b->empty() || ( a->low <= b->low && b->high <= a->high ) );
+        }
+
+        /* arithmetic operations */
+
+        /* Bounds of operations whose extremes lie in the corners of the
+         * operands, a NaN in a corner makes the bounds unknown. */
+        template< typename op_t >
+        static fv corners( fr a, fr b, op_t op )
+        {
+            auto w = a->bw;
+            bool nan = a->nan || b->nan;
+            if ( a->empty() || b->empty() )
+                return only_nan( w );
+
+            auto eval = [&] ( double x, double y ) {
+                return w == 32 ? double( op( float( x ), float( y ) ) ) : op( x, y );
+            };
+
+            double cs[] = { eval( a->low, b->low ), eval( a->low, b->high ),
+                            eval( a->high, b->low ), eval( a->high, b->high ) };
+
+            if ( std::any_of( std::begin( cs ), std::end( cs ), [] ( double c ) { return std::isnan( c ); } ) )
+                return top( w );
+
+            auto [lo, hi] = std::minmax_element( std::begin( cs ), std::end( cs ) );
+            return make( *lo, *hi, nan, w );
+        }
+
+        static fv op_fadd( fr a, fr b ) { return corners( a, b, [] ( auto x, auto y ) { return x + y; } ); }
+        static fv op_fsub( fr a, fr b ) { return corners( a, b, [] ( auto x, auto y ) { return x - y; } ); }
+        static fv op_fmul( fr a, fr b ) { return corners( a, b, [] ( auto x, auto y ) { return x * y; } ); }
+
+        static fv op_fdiv( fr a, fr b )
+        {
+            if ( !b->empty() && b->low <= 0 && 0 <= b->high )
+                return top( a->bw );
+            return corners( a, b, [] ( auto x, auto y ) { return x / y; } );
+        }
+
+        /* The remainder has the sign of the dividend and is smaller than the
+         * divisor in magnitude. */
+        static fv op_frem( fr a, fr b )
+        {
+            auto w = a->bw;
+            if ( a->empty() || b->empty() )
+                return only_nan( w );
+
+            bool nan = a->nan || b->nan || std::isinf( a->low ) || std::isinf( a->high )
+                    || ( b->low <= 0 && 0 <= b->high );
+            auto m = std::max( std::abs( b->low ), std::abs( b->high ) );
+            return make( std::max( -m, std::min( a->low, 0.0 ) ), std::min( m, std::max( a->high, 0.0 ) ), nan, w );
+        }
+
+        /* comparison operations */
+
+        /* whether a < b (or a <= b if not strict) holds for all or no values,
+         * ignoring NaNs */
+        static tristate less( fr a, fr b, bool strict )
+        {
+            if ( a->empty() || b->empty() )
+                return maybe;
+            if ( strict ? a->high < b->low : a->high <= b->low )
+                return tristate( true );
+            if ( strict ? a->low >= b->high : a->low > b->high )
+                return tristate( false );
+            return maybe;
+        }
+
+        static tristate equal( fr a, fr b )
+        {
+            if ( a->empty() || b->empty() )
+                return maybe;
+            if ( a->low == a->high && b->low == b->high && a->low == b->low )
+                return tristate( true );
+            if ( a->high < b->low || b->high < a->low )
+                return tristate( false );
+            return maybe;
+        }
+
+        static bool surely_unordered( fr a, fr b ) { return ( a->empty() && a->nan ) || ( b->empty() && b->nan ); }
+        static bool may_be_unordered( fr a, fr b ) { return a->nan || b->nan; }
+
+        /* ordered comparison: both are numbers and the relation holds */
+        static fv ordered( fr a, fr b, tristate rel )
+        {
+            if ( surely_unordered( a, b ) || rel == tristate( false ) )
+                return boolean( tristate( false ) );
+            if ( rel == tristate( true ) && !may_be_unordered( a, b ) )
+                return boolean( tristate( true ) );
+            return boolean( maybe );
+        }
+
+        /* unordered comparison: either is NaN or the relation holds */
+        static fv unordered( fr a, fr b, tristate rel ) { return boolean( !to_tristate( ordered( a, b, !rel ) ) ); }
+
+        static fv op_foeq( fr a, fr b ) { return ordered( a, b, equal( a, b ) ); }
+        static fv op_fone( fr a, fr b ) { return ordered( a, b, !equal( a, b ) ); }
+        static fv op_fogt( fr a, fr b ) { return ordered( a, b, less( b, a, true ) ); }
+        static fv op_foge( fr a, fr b ) { return ordered( a, b, less( b, a, false ) ); }
+        static fv op_folt( fr a, fr b ) { return ordered( a, b, less( a, b, true ) ); }
+        static fv op_fole( fr a, fr b ) { return ordered( a, b, less( a, b, false ) ); }
+
+        static fv op_fueq( fr a, fr b ) { return unordered( a, b, equal( a, b ) ); }
+        static fv op_fune( fr a, fr b ) { return unordered( a, b, !equal( a, b ) ); }
+        static fv op_fugt( fr a, fr b ) { return unordered( a, b, less( b, a, true ) ); }
+        static fv op_fuge( fr a, fr b ) { return unordered( a, b, less( b, a, false ) ); }
+        static fv op_fult( fr a, fr b ) { return unordered( a, b, less( a, b, true ) ); }
+        static fv op_fule( fr a, fr b ) { return unordered( a, b, less( a, b, false ) ); }
+
+        static fv op_ford( fr a, fr b ) { return ordered( a, b, tristate( true ) ); }
+        static fv op_funo( fr a, fr b ) { return unordered( a, b, tristate( false ) ); }
+
+        static fv op_ffalse( fr, fr ) { return boolean( tristate( false ) ); }
+        static fv op_ftrue ( fr, fr ) { return boolean( tristate( true ) ); }
+
+        /* connectives of comparison results */
+        static fv op_and( fr a, fr b ) { return boolean( to_tristate( a ) && to_tristate( b ) ); }
+        static fv op_or ( fr a, fr b ) { return boolean( to_tristate( a ) || to_tristate( b ) ); }
+        static fv op_xor( fr a, fr b ) { return boolean( to_tristate( a ) != to_tristate( b ) ); }
+
+        /* cast operations */
+        static fv op_fpext  ( fr a, bw w ) { return make( a->low, a->high, a->nan, w ); }
+        static fv op_fptrunc( fr a, bw w ) { return make( round( a->low, w ), round( a->high, w ), a->nan, w ); }
+        static fv op_sitofp ( fr a, bw w ) { return make( round( a->low, w ), round( a->high, w ), false, w ); }
+        static fv op_uitofp ( fr a, bw w ) { return op_sitofp( a, w ); }
+        static fv op_fptosi ( fr a, bw w ) { return make( std::trunc( a->low ), std::trunc( a->high ), false, w ); }
+        static fv op_fptoui ( fr a, bw w ) { return op_fptosi( a, w ); }
+
+        static fv op_zext ( fr a, bw w ) { return make( a->low, a->high, false, w ); }
+        static fv op_zfit ( fr a, bw w ) { return op_zext( a, w ); }
+        static fv op_trunc( fr a, bw w ) { return op_zext( a, w ); }
+        static fv op_sext ( fr a, bw w )
+        {
+            if ( a->bw == 1 ) // true extends to -1
+                return make( -a->high, -a->low, false, w );
+            return op_zext( a, w );
+        }
+
+        /* backward operations */
+
+        /* refines x < y (or x <= y if not strict) */
+        static void order( ref x, ref y, bool strict )
+        {
+            auto w = x->bw;
+            x.intersect( -inf, strict ? next( y->high, -inf, w ) : y->high );
+            y.intersect( strict ? next( x->low, inf, w ) : x->low, inf );
+        }
+
+        /* Outcome of a comparison, if it is known. */
+        static std::optional< bool > outcome( fr r )
+        {
+            auto t = to_tristate( r );
+            if ( maybe( t ) )
+                return std::nullopt;
+            return bool( t );
+        }
+
+        /* Refines the relation of a comparison. An ordered comparison is the
+         * relation of numbers, an unordered one holds for NaNs as well. The
+         * relation is known only if NaNs are excluded. */
+        template< typename refine_t >
+        static void bordered( fr r, ref a, ref b, refine_t refine, bool is_unordered = false )
+        {
+            auto res = outcome( r );
+            if ( !res )
+                return;
+
+            if ( *res != is_unordered ) {
+                a.exclude_nan();
+                b.exclude_nan();
+            } else if ( may_be_unordered( a, b ) ) {
+                return;
+            }
+            refine( a, b, *res );
+        }
+
+        static void bop_foeq( fr r, ref a, ref b ) { bordered( r, a, b, beq ); }
+        static void bop_fone( fr r, ref a, ref b ) { bordered( r, a, b, bne ); }
+        static void bop_fogt( fr r, ref a, ref b ) { bordered( r, a, b, bgt ); }
+        static void bop_foge( fr r, ref a, ref b ) { bordered( r, a, b, bge ); }
+        static void bop_folt( fr r, ref a, ref b ) { bordered( r, b, a, bgt ); }
+        static void bop_fole( fr r, ref a, ref b ) { bordered( r, b, a, bge ); }
+
+        static void bop_fueq( fr r, ref a, ref b ) { bordered( r, a, b, beq, true ); }
+        static void bop_fune( fr r, ref a, ref b ) { bordered( r, a, b, bne, true ); }
+        static void bop_fugt( fr r, ref a, ref b ) { bordered( r, a, b, bgt, true ); }
+        static void bop_fuge( fr r, ref a, ref b ) { bordered( r, a, b, bge, true ); }
+        static void bop_fult( fr r, ref a, ref b ) { bordered( r, b, a, bgt, true ); }
+        static void bop_fule( fr r, ref a, ref b ) { bordered( r, b, a, bge, true ); }
+
+        static void bop_ford( fr r, ref a, ref b )
+        {
+            if ( auto res = outcome( r ); res && *res ) {
+                a.exclude_nan();
+                b.exclude_nan();
+            }
+        }
+
+        static void bop_funo( fr r, ref a, ref b )
+        {
+            if ( auto res = outcome( r ); res && !*res ) {
+                a.exclude_nan();
+                b.exclude_nan();
+            }
+        }
+
+        /* relations of numbers given whether they hold */
+        static void beq( ref a, ref b, bool holds )
+        {
+            if ( holds ) {
+                a.intersect( b->low, b->high );
+                b.intersect( a->low, a->high );
+            }
+        }
+
+        static void bne( ref a, ref b, bool holds ) { beq( a, b, !holds ); }
+
+        static void bgt( ref a, ref b, bool holds )
+        {
+            if ( holds )
+                order( b, a, true );
+            else
+                order( a, b, false );
+        }
+
+        static void bge( ref a, ref b, bool holds )
+        {
+            if ( holds )
+                order( b, a, false );
+            else
+                order( a, b, true );
+        }
+
+        /* rounding makes arithmetic hard to invert, operands stay as they are */
+        static void bop_fadd( fr, fr, fr ) {}
+        static void bop_fsub( fr, fr, fr ) {}
+        static void bop_fmul( fr, fr, fr ) {}
+        static void bop_fdiv( fr, fr, fr ) {}
+        static void bop_frem( fr, fr, fr ) {}
+
+        static void bop_fpext  ( fr r, ref a ) { a.intersect( r->low, r->high ); }
+        static void bop_fptrunc( fr, fr ) {}
+        static void bop_sitofp ( fr, fr ) {}
+        static void bop_uitofp ( fr, fr ) {}
+        static void bop_fptosi ( fr, fr ) {}
+        static void bop_fptoui ( fr, fr ) {}
+
+        static std::string trace( fr v )
+        {
+            std::stringstream ss;
+            if ( v->is_bottom() )
+                return "bottom";
+            if ( !v->empty() )
+                ss << "[" << v->low << ", " << v->high << "]";
+            if ( v->nan )
+                ss << ( v->empty() ? "" : " ∪ " ) << "NaN";
+            return ss.str();
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, fr v ) { return os << trace( v ); }
+    };
+
+} // namespace __lava
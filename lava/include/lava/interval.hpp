@@ -8,6 +8,7 @@
 
 #include <lamp/support/semilattice.hpp>
 
+#include <array>
 #include <sstream>
 
 namespace __lava
@@ -155,6 +156,43 @@ namespace __lava
         static iv op_join( ir l, ir r ) { return join( l.get(), r.get() ); }
         static iv op_meet( ir l, ir r ) { return meet( l.get(), r.get() ); }
 
+        /* Widening thresholds are the extremes of common integer types. */
+        static constexpr std::array< bound_type, 12 > thresholds = {
+            -( bound_type( 1 ) << 31 ), -( 1 << 15 ), -( 1 << 7 ), -1, 0, 1,
+            ( 1 << 7 ) - 1, ( 1 << 8 ) - 1, ( 1 << 15 ) - 1, ( 1 << 16 ) - 1,
+            ( bound_type( 1 ) << 31 ) - 1, ( bound_type( 1 ) << 32 ) - 1
+        };
+
+        static bound lower_threshold( const bound &b )
+        {
+            for ( auto it = thresholds.rbegin(); it != thresholds.rend(); ++it )
+                if ( bound( *it ) <= b )
+                    return *it;
+            return minus_infinity();
+        }
+
+        static bound upper_threshold( const bound &b )
+        {
+            for ( auto t : thresholds )
+                if ( b <= bound( t ) )
+                    return t;
+            return plus_infinity();
+        }
+
+        /* An unstable bound jumps to the nearest threshold, hence each bound
+         * changes at most `thresholds.size() + 1` times. */
+        static iv op_widen( ir l, ir r )
+        {
+            if ( l.is_bottom() )
+                return r.clone();
+
+            auto low = r.low() < l.low() ? lower_threshold( r.low() ) : l.low();
+            auto high = l.high() < r.high() ? upper_threshold( r.high() ) : l.high();
+            return { low, high };
+        }
+
+        static bool subsumes( ir l, ir r ) { return r.is_bottom() || ( l.low() <= r.low() && r.high() <= l.high() ); }
+
         static iv op_add ( ir a, ir b ) { return a.get() + b.get(); }
         static iv op_sub ( ir a, ir b ) { return a.get() - b.get(); }
         static iv op_mul ( ir a, ir b ) { return a.get() * b.get(); }
@@ -183,9 +221,9 @@ namespace __lava
         static iv op_shl ( ir a, ir b ) { return a.get() << b.get(); }
         static iv op_ashr( ir a, ir b ) { return a.get() >> b.get(); } //FIXME
         static iv op_lshr( ir a, ir b ) { return a.get() >> b.get(); }
-        static iv op_and ( ir /* a */, ir /* b */ ) { return { plus_infinity(), minus_infinity() }; } //FIXME
-        static iv op_or  ( ir /* a */, ir /* b */ ) { return { plus_infinity(), minus_infinity() }; } //FIXME
-        static iv op_xor ( ir /* a */, ir /* b */ ) { return { plus_infinity(), minus_infinity() }; } //FIXME
+        static iv op_and ( ir /* a */, ir /* b */ ) { return top(); }
+        static iv op_or  ( ir /* a */, ir /* b */ ) { return top(); }
+        static iv op_xor ( ir /* a */, ir /* b */ ) { return top(); }
 
         static void validity_check( interval &i )
         {
@@ -0,0 +1,77 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/interval.hpp>
+#include <lava/known_bits.hpp>
+#include <lava/support/product.hpp>
+
+namespace __lava
+{
+    /* Intervals are unbounded and do not distinguish signedness, hence the
+     * components exchange bounds only for values that are non-negative in the
+     * bit-width, where all interpretations agree: known leading bits bound
+     * the interval and common leading bits of interval bounds are known. */
+    struct interval_bits_reduction
+    {
+        template< typename ival, typename bits >
+        static void reduce( ival &i, bits &k )
+        {
+            using bound = typename ival::bound;
+            auto smax = int64_t( k->sign() - 1 );
+
+            // with the sign bit known to be zero, unsigned bounds are below
+            // 2^(bw - 1), i.e., they fit the signed bound
+            if ( k->zeros & k->sign() ) {
+                auto lo = int64_t( k->umin() ), hi = int64_t( k->umax() );
+                i.intersect( { bound( lo ), bound( hi ) } );
+            }
+
+            if ( i.is_finite() && i.low() >= bound( 0 ) && i.high() <= bound( smax ) ) {
+                auto lo = uint64_t( int64_t( i.low() ) ), hi = uint64_t( int64_t( i.high() ) );
+                k.intersect( known_bits_storage::range( lo, hi, k->bw ) );
+            }
+        }
+    };
+
+    using interval_bits_config = product_config< lower_first, to_tristate_either, interval_bits_reduction >;
+
+    /* Reduced product of intervals and known bits, either component may
+     * decide a branch. */
+    template< template< typename > typename storage >
+    struct interval_bits : product< interval< storage >, known_bits< storage >, storage, interval_bits_config >
+    {
+        using ival = interval< storage >;
+        using bits = known_bits< storage >;
+
+        using base = product< ival, bits, storage, interval_bits_config >;
+        using base::base;
+
+        using pr = const base &;
+
+        interval_bits( base &&v ) : base( std::move( v ) ) {}
+
+        static std::string trace( pr v )
+        {
+            return "(" + ival::trace( v->first ) + ", " + bits::trace( v->second ) + ")";
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, const interval_bits &v ) { return os << trace( v ); }
+    };
+
+} // namespace __lava
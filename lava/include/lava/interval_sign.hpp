@@ -0,0 +1,101 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/interval.hpp>
+#include <lava/sign.hpp>
+#include <lava/support/product.hpp>
+
+namespace __lava
+{
+    /* The sign bounds the interval and the interval decides the sign. Zero
+     * can be cut off a nonzero interval only at its ends. */
+    struct interval_sign_reduction
+    {
+        template< typename ival >
+        static sign_storage::value_type sign_of( const ival &i )
+        {
+            using se = sign_storage;
+            using bound = typename ival::bound;
+
+            if ( i.low() > bound( 0 ) )
+                return se::gtz;
+            if ( i.high() < bound( 0 ) )
+                return se::ltz;
+            if ( i.low() == bound( 0 ) && i.high() == bound( 0 ) )
+                return se::eqz;
+            if ( i.low() == bound( 0 ) )
+                return se::gez;
+            if ( i.high() == bound( 0 ) )
+                return se::lez;
+            return se::top;
+        }
+
+        template< typename ival, typename sign >
+        static void reduce( ival &i, sign &s )
+        {
+            using se = sign_storage;
+            using bound = typename ival::bound;
+
+            auto minf = ival::minus_infinity(), pinf = ival::plus_infinity();
+
+            switch ( s.value() ) {
+                case se::bot: __lart_cancel(); return;
+                case se::ltz: i.intersect( { minf, bound( -1 ) } ); break;
+                case se::gtz: i.intersect( { bound( 1 ), pinf } ); break;
+                case se::eqz: i.intersect( { bound( 0 ), bound( 0 ) } ); break;
+                case se::gez: i.intersect( { bound( 0 ), pinf } ); break;
+                case se::lez: i.intersect( { minf, bound( 0 ) } ); break;
+                case se::nez:
+                    if ( i.low() == bound( 0 ) )
+                        i.intersect( { bound( 1 ), pinf } );
+                    else if ( i.high() == bound( 0 ) )
+                        i.intersect( { minf, bound( -1 ) } );
+                    break;
+                case se::top: break;
+            }
+
+            s.value() = sign::meet( s.value(), sign_of( i ) );
+        }
+    };
+
+    using interval_sign_config = product_config< lower_first, to_tristate_either, interval_sign_reduction >;
+
+    /* Reduced product of intervals and signs. */
+    template< template< typename > typename storage >
+    struct interval_sign : product< interval< storage >, sign< storage >, storage, interval_sign_config >
+    {
+        using ival = interval< storage >;
+        using sgn = sign< storage >;
+
+        using base = product< ival, sgn, storage, interval_sign_config >;
+        using base::base;
+
+        using pr = const base &;
+
+        interval_sign( base &&v ) : base( std::move( v ) ) {}
+
+        static std::string trace( pr v )
+        {
+            return "(" + ival::trace( v->first ) + ", " + sgn::trace( v->second ) + ")";
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, const interval_sign &v ) { return os << trace( v ); }
+    };
+
+} // namespace __lava
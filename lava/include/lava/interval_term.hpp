@@ -0,0 +1,92 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/interval.hpp>
+#include <lava/term.hpp>
+#include <lava/support/product.hpp>
+
+namespace __lava
+{
+    /* Constants are exchanged between the components: a singleton interval
+     * replaces the term, which keeps it out of solver queries, and a constant
+     * term bounds the interval. Bit-vector constants with the sign bit set
+     * are skipped, since intervals do not tell their signedness. */
+    struct interval_term_reduction
+    {
+        template< typename ival, typename term >
+        static void reduce( ival &i, term &t )
+        {
+            using bound = typename ival::bound;
+
+            auto &e = t.get();
+            bool singleton = i.is_finite() && i.low() == i.high();
+
+            if ( e.is_bool() ) {
+                if ( e.is_true() )
+                    i.intersect( { bound( 1 ), bound( 1 ) } );
+                else if ( e.is_false() )
+                    i.intersect( { bound( 0 ), bound( 0 ) } );
+                else if ( singleton )
+                    e = e.ctx().bool_val( i.low() != bound( 0 ) );
+                return;
+            }
+
+            if ( !e.is_bv() )
+                return;
+
+            auto w = e.get_sort().bv_size();
+            uint64_t value;
+            if ( e.is_numeral_u64( value ) ) {
+                // the numeral is the unsigned bit pattern, it is taken only if
+                // the sign bit is zero, where the signed and unsigned values
+                // agree and fit the signed bound
+                if ( w < 64 && value >> ( w - 1 ) == 0 )
+                    i.intersect( { bound( int64_t( value ) ), bound( int64_t( value ) ) } );
+            } else if ( singleton ) {
+                e = e.ctx().bv_val( int64_t( i.low() ), w );
+            }
+        }
+    };
+
+    using interval_term_config = product_config< lower_first, to_tristate_either, interval_term_reduction >;
+
+    /* Reduced product of intervals and terms, branches undecided by the
+     * intervals are left to the solver. */
+    template< template< typename > typename storage >
+    struct interval_term : product< interval< storage >, term< storage >, storage, interval_term_config >
+    {
+        using ival = interval< storage >;
+        using symbolic = term< storage >;
+
+        using base = product< ival, symbolic, storage, interval_term_config >;
+        using base::base;
+
+        using pr = const base &;
+
+        interval_term( base &&v ) : base( std::move( v ) ) {}
+
+        static std::string trace( pr v )
+        {
+            return "(" + ival::trace( v->first ) + ", " + symbolic::trace( v->second ) + ")";
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, const interval_term &v ) { return os << trace( v ); }
+    };
+
+} // namespace __lava
@@ -0,0 +1,523 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/base.hpp>
+#include <lava/support/scalar.hpp>
+#include <lava/support/reference.hpp>
+#include <lava/support/known_bits.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+namespace __lava
+{
+    using known_bits_storage = sup::known_bits;
+
+    /* Known-bits domain tracks bits of a value that are known to be zero or
+     * one, akin to tristate numbers of the Linux eBPF verifier. Transfer
+     * functions take constant time: bitwise operations and shifts by
+     * a constant are exact, arithmetic propagates known carries. */
+    template< template< typename > typename storage >
+    struct known_bits : storage< known_bits_storage >
+                      , domain_mixin< known_bits< storage > >
+    {
+        using base = storage< known_bits_storage >;
+        using mixin = domain_mixin< known_bits >;
+
+        using bw = typename mixin::bw;
+        using base::base;
+
+        using kb = known_bits;
+        using kr = const known_bits &;
+
+        using ref = domain_ref< known_bits >;
+
+        using value_t = known_bits_storage::value_t;
+        using signed_t = known_bits_storage::signed_t;
+
+        known_bits( const known_bits_storage &v ) : base( v ) {}
+
+        static kb top( bw w ) { return known_bits_storage::top( w ); }
+        static kb bottom( bw w ) { return known_bits_storage::bottom( w ); }
+        static kb constant( value_t v, bw w ) { return known_bits_storage::constant( v, w ); }
+
+        static value_t mask( bw w ) { return known_bits_storage::mask( w ); }
+
+        /* Number of bits clamped to the width, hence it fits the width type. */
+        static bw bits( value_t n, bw w ) { return bw( std::min< value_t >( n, w ) ); }
+
+        template< typename type > static auto lift( const type &v )
+            -> std::enable_if_t< std::is_integral_v< type >, kb >
+        {
+            return constant( value_t( v ), bitwidth_v< type > );
+        }
+
+        template< typename type > static auto lift( const type & )
+            -> std::enable_if_t< !std::is_integral_v< type >, kb >
+        {
+            return mixin::fail( "non-integral lift" );
+        }
+
+        template< typename type > static kb any()
+        {
+            if constexpr ( std::is_integral_v< type > )
+                return top( bitwidth_v< type > );
+            else
+                return mixin::fail( "non-integral any" );
+        }
+
+        template< typename type > static kb any( const variadic_list &args )
+        {
+            auto res = known_bits_storage::bottom( bitwidth_v< type > );
+            for ( auto v : args.range< type >() )
+                res = join( res, known_bits_storage::constant( value_t( v ), bitwidth_v< type > ) );
+            return res;
+        }
+
+        template< typename type > static kb any( type from, type to )
+        {
+            auto w = bitwidth_v< type >;
+            if constexpr ( std::is_signed_v< type > )
+                if ( ( from < 0 ) != ( to < 0 ) )
+                    return top( w );
+            return known_bits_storage::range( value_t( from ), value_t( to ), w );
+        }
+
+        void intersect( const known_bits_storage &other )
+        {
+            this->get() = meet( this->get(), other );
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
+
+        static void assume( known_bits &v, bool constraint )
+        {
+            auto w = v->bw;
+            if ( !constraint )
+                return v.intersect( known_bits_storage::constant( 0, w ) );
+
+            if ( v->zeros == mask( w ) )
+                __lart_cancel();
+            // the only unknown bit has to be set
+            auto u = v->unknown();
+            if ( !v->ones && ( u & ( u - 1 ) ) == 0 )
+                v.intersect( { 0, u, w } );
+        }
+
+        static tristate to_tristate( kr v )
+        {
+            return static_cast< tristate >( v.get() );
+        }
+
+        static bool undefined( kr a, kr b ) { return a->is_bottom() || b->is_bottom(); }
+
+        /* lattice operations */
+        static kb op_join( kr a, kr b ) { return join( a.get(), b.get() ); }
+        static kb op_meet( kr a, kr b ) { return meet( a.get(), b.get() ); }
+
+        /* Join is a widening already, each step forgets at least one bit. */
+        static bool subsumes( kr a, kr b ) { return join( a.get(), b.get() ) == a.get(); }
+
+        /* arithmetic operations */
+
+        /* Carries are unknown wherever the sum of minimal and maximal values
+         * differ. */
+        static kb op_add( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            auto sm = a->unknown() + b->unknown();
+            auto sv = a->ones + b->ones;
+            auto mu = ( ( sm + sv ) ^ sv ) | a->unknown() | b->unknown();
+            return known_bits_storage( ~( sv | mu ), sv & ~mu, w );
+        }
+
+        static kb op_sub( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            auto dv = a->ones - b->ones;
+            auto mu = ( ( dv + a->unknown() ) ^ ( dv - b->unknown() ) ) | a->unknown() | b->unknown();
+            return known_bits_storage( ~( dv | mu ), dv & ~mu, w );
+        }
+
+        /* Low bits of a product depend only on low bits of the operands and
+         * trailing zeros add up. */
+        static kb op_mul( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            auto low = mask( bits( std::min( a->trailing_known(), b->trailing_known() ), w ) );
+            auto zeros = mask( bits( a->trailing_zeros() + b->trailing_zeros(), w ) );
+            auto product = a->ones * b->ones;
+            return known_bits_storage( ( ~product & low ) | zeros, product & low, w );
+        }
+
+        /* Leading zeros common to all values not greater than `max`. */
+        static kb at_most( value_t max, bw w )
+        {
+            return known_bits_storage::range( 0, max, w );
+        }
+
+        static kb op_udiv( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            if ( b->is_constant() && b->ones != 0 ) {
+                if ( a->is_constant() )
+                    return constant( a->ones / b->ones, w );
+                if ( ( b->ones & ( b->ones - 1 ) ) == 0 )
+                    return op_lshr( a, constant( value_t( __builtin_ctzll( b->ones ) ), w ) );
+            }
+            return at_most( a->umax() / std::max< value_t >( b->umin(), 1 ), w );
+        }
+
+        static kb op_urem( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            if ( b->is_constant() && b->ones != 0 ) {
+                if ( a->is_constant() )
+                    return constant( a->ones % b->ones, w );
+                if ( ( b->ones & ( b->ones - 1 ) ) == 0 )
+                    return op_and( a, constant( b->ones - 1, w ) );
+            }
+            if ( b->umax() == 0 ) // division by zero
+                return top( w );
+            return at_most( std::min( a->umax(), b->umax() - 1 ), w );
+        }
+
+        /* Signed division is precise only for constants, overflow of the
+         * minimal value divided by -1 is left unknown. */
+        template< typename op_t >
+        static kb signed_division( kr a, kr b, op_t op )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            if ( !a->is_constant() || !b->is_constant() )
+                return top( w );
+            auto x = a->to_signed( a->ones ), y = b->to_signed( b->ones );
+            if ( y == 0 || ( y == -1 && a->ones == a->sign() ) )
+                return top( w );
+            return constant( value_t( op( x, y ) ), w );
+        }
+
+        static kb op_sdiv( kr a, kr b )
+        {
+            return signed_division( a, b, [] ( auto x, auto y ) { return x / y; } );
+        }
+
+        static kb op_srem( kr a, kr b )
+        {
+            // non-negative remainder by a power of two keeps the low bits
+            if ( b->is_constant() && ( a->zeros & a->sign() ) ) {
+                auto y = b->to_signed( b->ones );
+                auto m = value_t( y < 0 ? -y : y );
+                if ( m != 0 && ( m & ( m - 1 ) ) == 0 )
+                    return op_and( a, constant( m - 1, a->bw ) );
+            }
+            return signed_division( a, b, [] ( auto x, auto y ) { return x % y; } );
+        }
+
+        /* bitwise operations */
+        static kb op_and( kr a, kr b )
+        {
+            if ( undefined( a, b ) )
+                return bottom( a->bw );
+            return known_bits_storage( a->zeros | b->zeros, a->ones & b->ones, a->bw );
+        }
+
+        static kb op_or( kr a, kr b )
+        {
+            if ( undefined( a, b ) )
+                return bottom( a->bw );
+            return known_bits_storage( a->zeros & b->zeros, a->ones | b->ones, a->bw );
+        }
+
+        static kb op_xor( kr a, kr b )
+        {
+            if ( undefined( a, b ) )
+                return bottom( a->bw );
+            auto known = a->known() & b->known();
+            auto value = a->ones ^ b->ones;
+            return known_bits_storage( ~value & known, value & known, a->bw );
+        }
+
+        static kb op_not( kr a )
+        {
+            return known_bits_storage( a->ones, a->zeros, a->bw );
+        }
+
+        /* Shifts by an unknown amount keep at least the bits shifted in by
+         * the smallest possible amount. Amounts not smaller than the width
+         * give a poison value, i.e., anything. */
+        static kb op_shl( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            if ( b->umin() >= w )
+                return top( w );
+            if ( b->is_constant() ) {
+                auto s = b->ones;
+                return known_bits_storage( ( a->zeros << s ) | mask( bits( s, w ) ), a->ones << s, w );
+            }
+            auto zeros = bits( a->trailing_zeros() + b->umin(), w );
+            return known_bits_storage( mask( zeros ), 0, w );
+        }
+
+        static kb op_lshr( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            if ( b->umin() >= w )
+                return top( w );
+            if ( b->is_constant() ) {
+                auto s = b->ones;
+                return known_bits_storage( ( a->zeros >> s ) | ~( mask( w ) >> s ), a->ones >> s, w );
+            }
+            auto zeros = std::min< value_t >( w, a->leading_zeros() + b->umin() );
+            return known_bits_storage( ~( mask( w ) >> zeros ), 0, w );
+        }
+
+        static kb op_ashr( kr a, kr b )
+        {
+            auto w = a->bw;
+            if ( undefined( a, b ) )
+                return bottom( w );
+            if ( b->umin() >= w )
+                return top( w );
+            if ( b->is_constant() ) {
+                // shifted in copies of the sign bit are known iff the sign is
+                auto s = b->ones;
+                return known_bits_storage( value_t( a->to_signed( a->zeros ) >> s ),
+                                           value_t( a->to_signed( a->ones ) >> s ), w );
+            }
+            if ( a->zeros & a->sign() )
+                return op_lshr( a, b );
+            if ( a->ones & a->sign() ) {
+                auto n = std::min< value_t >( w, a->leading_ones() + b->umin() );
+                return known_bits_storage( 0, ~( mask( w ) >> n ), w );
+            }
+            return top( w );
+        }
+
+        /* comparison operations */
+        static kb compare( bool definitely, bool definitely_not )
+        {
+            if ( definitely )
+                return known_bits_storage::from_bool( true );
+            if ( definitely_not )
+                return known_bits_storage::from_bool( false );
+            return top( 1 );
+        }
+
+        static bool conflict( kr a, kr b )
+        {
+            return ( a->ones & b->zeros ) || ( a->zeros & b->ones );
+        }
+
+        static kb op_eq( kr a, kr b )
+        {
+            if ( undefined( a, b ) )
+                return bottom( 1 );
+            return compare( a->is_constant() && b->is_constant() && a->ones == b->ones, conflict( a, b ) );
+        }
+
+        static kb op_ne( kr a, kr b )
+        {
+            return known_bits_storage::from_tristate( !to_tristate( op_eq( a, b ) ) );
+        }
+
+        static kb op_ult( kr a, kr b ) { return compare( a->umax() <  b->umin(), a->umin() >= b->umax() ); }
+        static kb op_ule( kr a, kr b ) { return compare( a->umax() <= b->umin(), a->umin() >  b->umax() ); }
+        static kb op_ugt( kr a, kr b ) { return op_ult( b, a ); }
+        static kb op_uge( kr a, kr b ) { return op_ule( b, a ); }
+
+        static kb op_slt( kr a, kr b ) { return compare( a->smax() <  b->smin(), a->smin() >= b->smax() ); }
+        static kb op_sle( kr a, kr b ) { return compare( a->smax() <= b->smin(), a->smin() >  b->smax() ); }
+        static kb op_sgt( kr a, kr b ) { return op_slt( b, a ); }
+        static kb op_sge( kr a, kr b ) { return op_sle( b, a ); }
+
+        /* cast operations */
+        static kb op_trunc( kr a, bw w )
+        {
+            if ( a->is_bottom() )
+                return bottom( w );
+            return known_bits_storage( a->zeros, a->ones, w );
+        }
+
+        static kb op_zext( kr a, bw w )
+        {
+            return known_bits_storage( a->zeros | ( mask( w ) & ~mask( a->bw ) ), a->ones, w );
+        }
+
+        static kb op_sext( kr a, bw w )
+        {
+            return known_bits_storage( value_t( a->to_signed( a->zeros ) ), value_t( a->to_signed( a->ones ) ), w );
+        }
+
+        static kb op_zfit( kr a, bw w )
+        {
+            return w < a->bw ? op_trunc( a, w ) : op_zext( a, w );
+        }
+
+        static kb op_concat( kr a, kr b )
+        {
+            auto w = bw( a->bw + b->bw );
+            return known_bits_storage( ( a->zeros << b->bw ) | b->zeros, ( a->ones << b->bw ) | b->ones, w );
+        }
+
+        /* backward operations */
+        static void bop_add( kr r, ref a, ref b )
+        {
+            a.intersect( op_sub( r, b ).get() );
+            b.intersect( op_sub( r, a ).get() );
+        }
+
+        static void bop_sub( kr r, ref a, ref b )
+        {
+            a.intersect( op_add( r, b ).get() );
+            b.intersect( op_sub( a, r ).get() );
+        }
+
+        /* Ones of the result are ones in both operands, a zero of the result
+         * with a one in the other operand is a zero. */
+        static void bop_and( kr r, ref a, ref b )
+        {
+            auto w = r->bw;
+            a.intersect( { r->zeros & b->ones, r->ones, w } );
+            b.intersect( { r->zeros & a->ones, r->ones, w } );
+        }
+
+        static void bop_or( kr r, ref a, ref b )
+        {
+            auto w = r->bw;
+            a.intersect( { r->zeros, r->ones & b->zeros, w } );
+            b.intersect( { r->zeros, r->ones & a->zeros, w } );
+        }
+
+        static void bop_xor( kr r, ref a, ref b )
+        {
+            a.intersect( op_xor( r, b ).get() );
+            b.intersect( op_xor( r, a ).get() );
+        }
+
+        static void bop_trunc( kr r, ref a ) { a.intersect( { r->zeros, r->ones, a->bw } ); }
+        static void bop_zext( kr r, ref a )  { a.intersect( op_trunc( r, a->bw ).get() ); }
+        static void bop_sext( kr r, ref a )  { a.intersect( op_trunc( r, a->bw ).get() ); }
+        static void bop_zfit( kr r, ref a )
+        {
+            if ( a->bw < r->bw )
+                a.intersect( op_trunc( r, a->bw ).get() );
+            else
+                bop_trunc( r, a );
+        }
+
+        /* Outcome of a comparison, if it is known. */
+        static std::optional< bool > outcome( kr r )
+        {
+            if ( !r->is_constant() )
+                return std::nullopt;
+            return r->ones != 0;
+        }
+
+        static void beq( kr r, ref a, ref b, bool negated = false )
+        {
+            auto res = outcome( r );
+            if ( !res )
+                return;
+
+            if ( *res != negated ) {
+                a.intersect( b.get() );
+                b.intersect( a.get() );
+            } else if ( a->is_constant() && b->is_constant() && a->ones == b->ones ) {
+                __lart_cancel();
+            }
+        }
+
+        /* Refines a < b (or a <= b if not strict) in unsigned order, the
+         * smaller operand has at least as many leading zeros as the bound. */
+        static void bult( ref a, ref b, bool strict )
+        {
+            value_t d = strict ? 1 : 0;
+            if ( b->umax() < d )
+                __lart_cancel();
+            a.intersect( at_most( b->umax() - d, a->bw ).get() );
+        }
+
+        /* Refines a < b (or a <= b if not strict) in signed order, only the
+         * sign bits can be inferred. */
+        static void bslt( ref a, ref b, bool strict )
+        {
+            signed_t d = strict ? 1 : 0;
+            if ( b->smax() - d < 0 )
+                a.intersect( { 0, a->sign(), a->bw } );
+            if ( a->smin() + d > 0 )
+                b.intersect( { b->sign(), 0, b->bw } );
+        }
+
+        template< typename refine_t >
+        static void blt( kr r, ref a, ref b, refine_t refine )
+        {
+            if ( auto res = outcome( r ) ) {
+                if ( *res )
+                    refine( a, b, true );
+                else
+                    refine( b, a, false );
+            }
+        }
+
+        static void bop_eq( kr r, kr a, kr b ) { beq( r, a, b ); }
+        static void bop_ne( kr r, kr a, kr b ) { beq( r, a, b, true /* negated */ ); }
+
+        static void bop_ult( kr r, kr a, kr b ) { blt( r, a, b, bult ); }
+        static void bop_ugt( kr r, kr a, kr b ) { blt( r, b, a, bult ); }
+        static void bop_ule( kr r, kr a, kr b ) { blt( r, b, a, [] ( ref x, ref y, bool strict ) { bult( y, x, !strict ); } ); }
+        static void bop_uge( kr r, kr a, kr b ) { bop_ule( r, b, a ); }
+
+        static void bop_slt( kr r, kr a, kr b ) { blt( r, a, b, bslt ); }
+        static void bop_sgt( kr r, kr a, kr b ) { blt( r, b, a, bslt ); }
+        static void bop_sle( kr r, kr a, kr b ) { blt( r, b, a, [] ( ref x, ref y, bool strict ) { bslt( y, x, !strict ); } ); }
+        static void bop_sge( kr r, kr a, kr b ) { bop_sle( r, b, a ); }
+
+        static std::string trace( kr v )
+        {
+            if ( v->is_bottom() )
+                return "bottom";
+
+            std::string bits;
+            for ( int i = v->bw - 1; i >= 0; --i ) {
+                auto bit = value_t( 1 ) << i;
+                bits += v->ones & bit ? '1' : v->zeros & bit ? '0' : 'x';
+            }
+            return bits;
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, kr v ) { return os << trace( v ); }
+    };
+} // namespace __lava
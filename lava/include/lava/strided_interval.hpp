@@ -0,0 +1,100 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/interval.hpp>
+#include <lava/congruence.hpp>
+#include <lava/support/product.hpp>
+
+namespace __lava
+{
+    /* Finite bounds are moved to the nearest members of the congruence and
+     * a singleton in either component fixes the other one. */
+    struct strided_interval_reduction
+    {
+        template< typename ival, typename cong >
+        static void reduce( ival &i, cong &c )
+        {
+            using bound = typename ival::bound;
+            using wide_t = congruence_storage::wide_t;
+
+            if ( c->is_constant() )
+                return i.intersect( { bound( c->offset ), bound( c->offset ) } );
+
+            if ( i.is_finite() && i.low() == i.high() )
+                return c.intersect( congruence_storage::constant( int64_t( i.low() ) ) );
+
+            if ( c->is_top() )
+                return;
+
+            auto low = i.low(), high = i.high();
+            if ( low != ival::minus_infinity() )
+                low = bound( int64_t( low ) + congruence_storage::residue( wide_t( c->offset ) - int64_t( low ), c->stride ) );
+            if ( high != ival::plus_infinity() )
+                high = bound( int64_t( high ) - congruence_storage::residue( wide_t( int64_t( high ) ) - c->offset, c->stride ) );
+
+            i.intersect( { low, high } );
+            if ( i.is_finite() && i.low() == i.high() )
+                c.intersect( congruence_storage::constant( int64_t( i.low() ) ) );
+        }
+    };
+
+    using strided_interval_config = product_config< lower_first, to_tristate_either, strided_interval_reduction >;
+
+    /* Strided intervals, i.e., the reduced product of intervals and
+     * congruences. Concretization enumerates only the members of the
+     * congruence within the bounds, so strided accesses branch fewer times
+     * by the stride factor. */
+    template< template< typename > typename storage >
+    struct strided_interval : product< interval< storage >, congruence< storage >, storage, strided_interval_config >
+    {
+        using ival = interval< storage >;
+        using cong = congruence< storage >;
+
+        using base = product< ival, cong, storage, strided_interval_config >;
+        using base::base;
+
+        using pr = const base &;
+
+        using constant_type = typename ival::constant_type;
+        using bound_type = typename ival::bound_type;
+
+        strided_interval( base &&v ) : base( std::move( v ) ) {}
+
+        static constant_type lower( pr v )
+        {
+            const auto &i = v->first;
+            const auto &c = v->second;
+            if ( c->stride <= 1 )
+                return ival::lower( i );
+
+            auto count = ( bound_type( i.high() ) - bound_type( i.low() ) ) / bound_type( c->stride ) + 1;
+            return constant_type::lift(
+                bound_type( i.low() ) + bound_type( c->stride ) * __lart_choose( int( count ) )
+            );
+        }
+
+        static std::string trace( pr v )
+        {
+            return "(" + ival::trace( v->first ) + ", " + cong::trace( v->second ) + ")";
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, const strided_interval &v ) { return os << trace( v ); }
+    };
+
+} // namespace __lava
@@ -183,6 +183,12 @@ namespace __lava
         static st op_join( sr, sr ) { return fail( "join" ); }
         static st op_meet( sr, sr ) { return fail( "meet" ); }
 
+        /* Widening defaults to join, which suffices for finite-height domains. */
+        static st op_widen( sr a, sr b ) { return st::op_join( a, b ); }
+
+        /* Whether `a` over-approximates `b`, used to detect loop fixpoints. */
+        static bool subsumes( sr, sr ) { return false; }
+
         static st op_not ( sr ) { return fail( "not" ); }
         static st op_neg ( sr ) { return fail( "neg" ); }
 
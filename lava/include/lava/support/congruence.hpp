@@ -0,0 +1,202 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <numeric>
+
+#include "tristate.hpp"
+
+namespace sup
+{
+    /* Values congruent to `offset` modulo `stride`, i.e., the set
+     * { offset + k * stride }. Stride zero stands for the single value
+     * `offset` and stride one for all values, see Granger, Static Analysis of
+     * Arithmetical Congruences. Like intervals, congruences are over
+     * unbounded integers. */
+    struct congruence
+    {
+        using value_t = int64_t;
+        using stride_t = uint64_t;
+        __extension__ typedef __int128 wide_t;
+
+        stride_t stride = 1;
+        value_t offset = 0;
+        bool empty = false;
+
+        constexpr congruence() = default;
+
+        constexpr congruence( stride_t s, wide_t o ) : stride( s ), offset( residue( o, s ) ) {}
+
+        static constexpr value_t residue( wide_t o, stride_t s )
+        {
+            if ( s == 0 )
+                return value_t( o );
+            auto r = o % wide_t( s );
+            return value_t( r < 0 ? r + wide_t( s ) : r );
+        }
+
+        static constexpr congruence top() { return {}; }
+        static constexpr congruence constant( value_t v ) { return { 0, v }; }
+
+        static constexpr congruence bottom()
+        {
+            congruence c;
+            c.empty = true;
+            return c;
+        }
+
+        static constexpr congruence from_bool( bool b ) { return constant( b ); }
+
+        static constexpr congruence from_tristate( __lava::tristate t )
+        {
+            if ( __lava::maybe( t ) )
+                return top();
+            return from_bool( static_cast< bool >( t ) );
+        }
+
+        /* The stride of a product or a sum that does not fit falls back to
+         * top, which is a congruence modulo one. */
+        static constexpr congruence make( wide_t s, wide_t o )
+        {
+            if ( s < 0 )
+                s = -s;
+            if ( s > wide_t( INT64_MAX ) || ( s == 0 && ( o > INT64_MAX || o < INT64_MIN ) ) )
+                return top();
+            return { stride_t( s ), o };
+        }
+
+        constexpr bool is_bottom() const { return empty; }
+        constexpr bool is_top() const { return !empty && stride == 1; }
+        constexpr bool is_constant() const { return !empty && stride == 0; }
+
+        constexpr bool contains( wide_t v ) const
+        {
+            if ( empty )
+                return false;
+            if ( stride == 0 )
+                return v == offset;
+            return residue( v, stride ) == offset;
+        }
+
+        constexpr bool includes( const congruence &o ) const
+        {
+            if ( o.empty )
+                return true;
+            if ( empty )
+                return false;
+            if ( o.stride == 0 )
+                return contains( o.offset );
+            return stride != 0 && o.stride % stride == 0 && contains( o.offset );
+        }
+
+        explicit constexpr operator __lava::tristate() const noexcept
+        {
+            if ( is_constant() )
+                return __lava::tristate( offset != 0 );
+            if ( !contains( 0 ) )
+                return __lava::tristate( true );
+            return __lava::tristate( __lava::maybe );
+        }
+
+        static constexpr wide_t gcd( wide_t a, wide_t b )
+        {
+            a = a < 0 ? -a : a;
+            b = b < 0 ? -b : b;
+            while ( b ) {
+                auto t = a % b;
+                a = b;
+                b = t;
+            }
+            return a;
+        }
+
+        friend constexpr congruence join( const congruence &a, const congruence &b )
+        {
+            if ( a.empty )
+                return b;
+            if ( b.empty )
+                return a;
+            auto s = gcd( gcd( a.stride, b.stride ), wide_t( a.offset ) - b.offset );
+            return make( s, a.offset );
+        }
+
+        /* Chinese remainder theorem, the intersection is a congruence modulo
+         * the least common multiple of the strides. */
+        friend constexpr congruence meet( const congruence &a, const congruence &b )
+        {
+            if ( a.empty || b.empty )
+                return bottom();
+            if ( a.stride == 0 )
+                return b.contains( a.offset ) ? a : bottom();
+            if ( b.stride == 0 )
+                return a.contains( b.offset ) ? b : bottom();
+
+            wide_t g = gcd( a.stride, b.stride );
+            wide_t diff = wide_t( b.offset ) - a.offset;
+            if ( diff % g != 0 )
+                return bottom();
+
+            wide_t m = b.stride / g;
+            wide_t lcm = wide_t( a.stride ) * m;
+            if ( lcm > INT64_MAX ) // keep the finer congruence
+                return a.stride >= b.stride ? a : b;
+
+            // x = a.offset + a.stride * t, where t = diff / g * inverse( a.stride / g ) mod m
+            wide_t r0 = ( wide_t( a.stride ) / g ) % m, r1 = m, s0 = 1, s1 = 0;
+            while ( r1 ) {
+                auto q = r0 / r1;
+                auto r = r0 - q * r1;
+                auto s = s0 - q * s1;
+                r0 = r1; r1 = r;
+                s0 = s1; s1 = s;
+            }
+            wide_t t = ( diff / g ) % m * ( s0 % m ) % m;
+            return { stride_t( lcm ), wide_t( a.offset ) + wide_t( a.stride ) * t };
+        }
+
+        friend constexpr congruence operator+( const congruence &a, const congruence &b )
+        {
+            if ( a.empty || b.empty )
+                return bottom();
+            return make( gcd( a.stride, b.stride ), wide_t( a.offset ) + b.offset );
+        }
+
+        friend constexpr congruence operator-( const congruence &a, const congruence &b )
+        {
+            if ( a.empty || b.empty )
+                return bottom();
+            return make( gcd( a.stride, b.stride ), wide_t( a.offset ) - b.offset );
+        }
+
+        friend constexpr congruence operator*( const congruence &a, const congruence &b )
+        {
+            if ( a.empty || b.empty )
+                return bottom();
+            wide_t sa = a.stride, sb = b.stride, oa = a.offset, ob = b.offset;
+            return make( gcd( gcd( sa * sb, sa * ob ), sb * oa ), oa * ob );
+        }
+
+        constexpr bool operator==( const congruence &o ) const
+        {
+            if ( empty || o.empty )
+                return empty == o.empty;
+            return stride == o.stride && offset == o.offset;
+        }
+    };
+
+} // namespace sup
@@ -0,0 +1,105 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace sup
+{
+    /* Dense difference-bound matrix over `size` variables, where variable 0 is
+     * the constant zero. Entry (i, j) = c encodes the constraint x_i - x_j <= c.
+     * The matrix is kept closed (all constraints are the tightest implied
+     * ones), hence bounds and entailment are single lookups. */
+    template< unsigned size >
+    struct dbm
+    {
+        using value_t = int64_t;
+
+        /* large enough to be unbounded, small enough so that sums do not overflow */
+        static constexpr value_t inf = value_t( 1 ) << 60;
+
+        static constexpr bool finite( value_t v ) { return v > -inf && v < inf; }
+
+        dbm() { clear(); }
+
+        value_t  at( unsigned i, unsigned j ) const { return _m[ i * size + j ]; }
+        value_t &at( unsigned i, unsigned j )       { return _m[ i * size + j ]; }
+
+        value_t upper( unsigned v ) const { return at( v, 0 ); }
+        value_t lower( unsigned v ) const { return -at( 0, v ); }
+
+        void clear()
+        {
+            _m.fill( inf );
+            for ( unsigned i = 0; i < size; ++i )
+                at( i, i ) = 0;
+        }
+
+        /* drops all constraints of variable `v` */
+        void forget( unsigned v )
+        {
+            for ( unsigned i = 0; i < size; ++i )
+                at( i, v ) = at( v, i ) = inf;
+            at( v, v ) = 0;
+        }
+
+        /* Whether x - y <= c follows from the matrix. */
+        bool entails( unsigned x, unsigned y, value_t c ) const { return at( x, y ) <= c; }
+
+        /* Adds x - y <= c and restores closure in O(size^2): the only new
+         * shortest paths are i ~> x -> y ~> j. The inner loop is branch-free
+         * over contiguous rows, so that it vectorizes. Returns false when the
+         * constraint is inconsistent with the matrix. */
+        bool constrain( unsigned x, unsigned y, value_t c )
+        {
+            if ( !finite( c ) )
+                return c > 0;
+            if ( at( x, y ) <= c )
+                return true;
+            if ( at( y, x ) < inf && c + at( y, x ) < 0 )
+                return false;
+
+            const value_t *row_y = &_m[ y * size ];
+            for ( unsigned i = 0; i < size; ++i ) {
+                auto ix = at( i, x );
+                if ( ix >= inf )
+                    continue;
+
+                auto via = ix + c;
+                value_t *row_i = &_m[ i * size ];
+                for ( unsigned j = 0; j < size; ++j ) {
+                    auto path = row_y[ j ] >= inf ? inf : via + row_y[ j ];
+                    row_i[ j ] = std::min( row_i[ j ], path );
+                }
+            }
+
+            return true;
+        }
+
+        /* Constrains lo <= x - y <= hi. */
+        bool constrain( unsigned x, unsigned y, value_t lo, value_t hi )
+        {
+            return constrain( x, y, hi ) && constrain( y, x, lo <= -inf ? inf : -lo );
+        }
+
+    private:
+        alignas( 64 ) std::array< value_t, size * size > _m;
+    };
+
+} // namespace sup
@@ -16,10 +16,9 @@
 
 #pragma once
 
-#include <memory>
-#include <vector>
-
-#include <runtime/vector.hpp>
+#include <array>
+#include <cstdint>
+#include <span>
 
 #include <lava/support/base.hpp>
 #include <lava/support/tristate.hpp>
@@ -27,16 +26,26 @@
 
 namespace __lava
 {
+    /* History node keeps the value inline together with pointers to the
+     * operands of the operation that produced it. */
     template< typename domain >
     struct /* [[gnu::packed]] */ history_storage
     {
+        static constexpr unsigned max_arity = 2;
+
         constexpr history_storage(domain &&v)
-            : value( std::make_shared< domain >( std::move(v) ) )
+            : value( std::move(v) )
         {}
 
-        std::shared_ptr< domain > value;
-        // TODO: shared pointers< with_shistory > to children
-        std::vector< void* > children;
+        void push( void *child ) { _children[ _arity++ ] = child; }
+
+        std::span< void * const > children() const { return { _children.data(), _arity }; }
+
+        domain value;
+
+    private:
+        std::array< void*, max_arity > _children = {};
+        uint8_t _arity = 0;
     };
 
     template< typename domain, template< typename > typename storage >
@@ -77,15 +86,24 @@ namespace __lava
             return domain::to_tristate( value(a) );
         }
 
-        static const domain& value(sref v) { return *v->value; }
-        static domain& value(self &v) { return *v->value; }
+        static const domain& value(sref v) { return v->value; }
+        static domain& value(self &v) { return v->value; }
+
+        /* the clone shares operands with the original value */
+        self clone() const
+        {
+            self r = value( *this ).clone();
+            for ( auto ch : this->get().children() )
+                r->push( ch );
+            return r;
+        }
 
         template< typename op_t >
         static self bin( op_t op, sref a, sref b )
         {
             self r = op( value(a), value(b) );
-            r->children.push_back( a.unsafe_ptr() );
-            r->children.push_back( b.unsafe_ptr() );
+            r->push( a.unsafe_ptr() );
+            r->push( b.unsafe_ptr() );
             return r;
         }
 
@@ -93,10 +111,14 @@ namespace __lava
         static self cast( op_t op, sref a, bw b )
         {
             self r = op( value(a), b );
-            r->children.push_back( a.unsafe_ptr() );
+            r->push( a.unsafe_ptr() );
             return r;
         }
 
+        /* widening starts a fresh history */
+        static self op_widen( sref a, sref b ) { return domain::op_widen( value(a), value(b) ); }
+        static bool subsumes( sref a, sref b ) { return domain::subsumes( value(a), value(b) ); }
+
         /* arithmetic operations */
         static self op_add ( sref a, sref b ) { return bin( domain::op_add, a, b ); }
         static self op_fadd( sref a, sref b ) { return bin( domain::op_fadd, a, b ); }
@@ -165,7 +187,7 @@ namespace __lava
         template< typename stream >
         friend stream& operator<<( stream &os, sref v )
         {
-            return os << *v->value;
+            return os << v->value;
         }
 
         using mixin::report;
@@ -0,0 +1,455 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <z3++.h>
+
+#include <lava/support/query_cache.hpp>
+
+namespace __lava
+{
+    /* Union-find over symbolic variables of a path condition. Variables are
+     * identified by the numeric suffix of the `var_N` names given to them by
+     * `term::any`, hence the identifiers are dense and can index a vector. */
+    struct variable_partition
+    {
+        unsigned find( unsigned v )
+        {
+            grow( v );
+            while ( _parent[ v ] != v ) {
+                _parent[ v ] = _parent[ _parent[ v ] ];
+                v = _parent[ v ];
+            }
+            return v;
+        }
+
+        unsigned unite( unsigned a, unsigned b )
+        {
+            a = find( a );
+            b = find( b );
+            if ( a == b )
+                return a;
+
+            if ( _rank[ a ] < _rank[ b ] )
+                std::swap( a, b );
+            _parent[ b ] = a;
+            if ( _rank[ a ] == _rank[ b ] )
+                ++_rank[ a ];
+            return a;
+        }
+
+    private:
+        void grow( unsigned v )
+        {
+            if ( v < _parent.size() )
+                return;
+            auto size = _parent.size();
+            _parent.resize( v + 1 );
+            _rank.resize( v + 1, 0 );
+            std::iota( std::next( _parent.begin(), std::ptrdiff_t( size ) ), _parent.end(), unsigned( size ) );
+        }
+
+        std::vector< unsigned > _parent;
+        std::vector< uint8_t > _rank;
+    };
+
+    /* Path condition split into independent slices. A constraint joins the
+     * partition of every variable it mentions, and a query is decided only
+     * against the constraints that (transitively) share a variable with it.
+     * Slices that were already found satisfiable are remembered, so re-asserting
+     * a constraint that is already part of the path does not reach the solver,
+     * neither does a query satisfied by the model of the last solved slice.
+     *
+     * When a query cache is attached, slices are additionally looked up by the
+     * canonical hashes of their constraints, which are stable across forked
+     * processes (unlike z3 expression ids). */
+    struct path_condition
+    {
+        using variables_t = std::vector< unsigned >;
+
+        struct constraint
+        {
+            z3::expr expr;
+            variables_t vars;
+            query_hash hash;
+        };
+
+        /* Decision procedure for slices that reach the solver. */
+        using solve_t = z3::check_result (*)( z3::solver & );
+
+        explicit path_condition( z3::context &ctx ) : _solver( ctx ) {}
+
+        void cache( query_cache *c ) { _cache = c; }
+        void solve( solve_t s ) { _solve = s; }
+
+        /* Limits (e.g., timeout, max_memory) of each query of the solver. */
+        void limits( const z3::params &p ) { _solver.set( p ); }
+
+        void add( const z3::expr &c )
+        {
+            auto vars = variables( c );
+            for ( auto v : vars )
+                _partition.unite( vars.front(), v );
+            auto hash = canonical_hash( c, vars );
+            _constraints.push_back( { c, std::move( vars ), hash } );
+        }
+
+        /* Constraints of the path condition relevant for the query, followed
+         * by the query itself. */
+        z3::expr_vector slice( const z3::expr &query )
+        {
+            z3::expr_vector result( query.ctx() );
+            for ( auto idx : slice_indices( variables( query ) ) )
+                result.push_back( _constraints[ idx ].expr );
+            result.push_back( query );
+            return result;
+        }
+
+        /* Satisfiability of the path condition conjoined with the query. */
+        z3::check_result check( const z3::expr &query )
+        {
+            auto vars = variables( query );
+            auto indices = slice_indices( vars );
+
+            auto key = slice_key( indices, query );
+            if ( _sat_slices.count( key ) )
+                return z3::sat;
+
+            if ( satisfied( indices, query ) ) {
+                _sat_slices.emplace( std::move( key ), query );
+                return z3::sat;
+            }
+
+            query_key cache_key;
+            if ( _cache ) {
+                cache_key = canonical_key( indices, query, vars );
+                if ( auto e = _cache->lookup( cache_key ) ) {
+                    if ( e->result == query_cache::status::unsat )
+                        return z3::unsat;
+                    adopt( *e );
+                    _sat_slices.emplace( std::move( key ), query );
+                    return z3::sat;
+                }
+            }
+
+            _solver.reset();
+            for ( auto idx : indices )
+                _solver.add( _constraints[ idx ].expr );
+            _solver.add( query );
+
+            auto result = solve();
+            if ( result == z3::sat ) {
+                _sat_slices.emplace( std::move( key ), query );
+                remember_model();
+            }
+
+            if ( _cache && result != z3::unknown )
+                store( cache_key, result, indices, vars );
+            return result;
+        }
+
+        /* Satisfiability of the query like `check`, but a satisfiable result
+         * always comes with a witness in `model()` (unless the solver that
+         * decided the query does not provide one). */
+        z3::check_result witness( const z3::expr &query )
+        {
+            auto vars = variables( query );
+            auto indices = slice_indices( vars );
+            if ( satisfied( indices, query ) )
+                return z3::sat;
+
+            query_key cache_key;
+            if ( _cache ) {
+                cache_key = canonical_key( indices, query, vars );
+                if ( auto e = _cache->lookup( cache_key ) ) {
+                    if ( e->result == query_cache::status::unsat )
+                        return z3::unsat;
+                    if ( adopt( *e ) && satisfied( indices, query ) )
+                        return z3::sat;
+                }
+            }
+
+            _solver.reset();
+            for ( auto idx : indices )
+                _solver.add( _constraints[ idx ].expr );
+            _solver.add( query );
+
+            auto result = solve();
+            if ( result == z3::sat )
+                remember_model();
+
+            if ( _cache && result != z3::unknown )
+                store( cache_key, result, indices, vars );
+            return result;
+        }
+
+        const std::optional< z3::model > &model() const { return _model; }
+
+        /* Copies values of the variables in the slice of the query from the
+         * last witness to the assignment, other variables are left intact as
+         * the slices are independent. */
+        void update( z3::model &assignment, const z3::expr &query )
+        {
+            assert( _model );
+            auto vars = variables( query );
+            for ( auto idx : slice_indices( vars ) ) {
+                const auto &c = _constraints[ idx ];
+                vars.insert( vars.end(), c.vars.begin(), c.vars.end() );
+            }
+
+            for ( auto v : vars ) {
+                auto sym = _symbols.at( v );
+                auto decl = sym.decl();
+                auto value = _model->eval( sym, true );
+                assignment.add_const_interp( decl, value );
+            }
+        }
+
+        const std::vector< constraint > &constraints() const { return _constraints; }
+
+        /* Numeric suffix of a `var_N` variable. */
+        static unsigned variable_id( const z3::expr &var )
+        {
+            constexpr std::string_view prefix = "var_";
+            auto name = var.decl().name().str();
+            assert( std::string_view( name ).substr( 0, prefix.size() ) == prefix );
+
+            unsigned id = 0;
+            std::from_chars( name.data() + prefix.size(), name.data() + name.size(), id );
+            return id;
+        }
+
+        /* Variables of the expression, their symbols are remembered to
+         * extract models of cached queries. */
+        variables_t variables( const z3::expr &e )
+        {
+            variables_t vars;
+            std::unordered_set< unsigned > visited;
+            std::vector< z3::expr > todo{ e };
+
+            while ( !todo.empty() ) {
+                auto n = todo.back();
+                todo.pop_back();
+
+                if ( !visited.insert( n.id() ).second )
+                    continue;
+
+                if ( is_variable( n ) ) {
+                    vars.push_back( variable_id( n ) );
+                    _symbols.emplace( vars.back(), n );
+                    continue;
+                }
+
+                if ( n.is_app() ) {
+                    for ( unsigned i = 0; i < n.num_args(); ++i )
+                        todo.push_back( n.arg( i ) );
+                }
+            }
+
+            std::sort( vars.begin(), vars.end() );
+            vars.erase( std::unique( vars.begin(), vars.end() ), vars.end() );
+            return vars;
+        }
+
+    private:
+        static bool is_variable( const z3::expr &e )
+        {
+            return e.is_const() && e.decl().decl_kind() == Z3_OP_UNINTERPRETED;
+        }
+
+        std::vector< unsigned > slice_indices( const variables_t &vars )
+        {
+            std::unordered_set< unsigned > roots;
+            for ( auto v : vars )
+                roots.insert( _partition.find( v ) );
+
+            std::vector< unsigned > indices;
+            for ( unsigned idx = 0; idx < _constraints.size(); ++idx ) {
+                const auto &c = _constraints[ idx ];
+                if ( !c.vars.empty() && roots.count( _partition.find( c.vars.front() ) ) )
+                    indices.push_back( idx );
+            }
+            return indices;
+        }
+
+        /* Whether the remembered model is a witness of the slice and query,
+         * variables it does not mention are completed arbitrarily. */
+        bool satisfied( const std::vector< unsigned > &indices, const z3::expr &query )
+        {
+            if ( !_model )
+                return false;
+
+            auto holds = [&] ( const z3::expr &e ) { return _model->eval( e, true ).is_true(); };
+            if ( !holds( query ) )
+                return false;
+            return std::all_of( indices.begin(), indices.end(), [&] ( auto idx ) {
+                return holds( _constraints[ idx ].expr );
+            } );
+        }
+
+        /* A solver that runs out of its limits may throw instead of returning
+         * unknown, the query is then inconclusive as well. */
+        z3::check_result solve()
+        {
+            try {
+                return _solve ? _solve( _solver ) : _solver.check();
+            } catch ( z3::exception & ) {
+                return z3::unknown;
+            }
+        }
+
+        void remember_model()
+        {
+            try {
+                _model = _solver.get_model();
+            } catch ( z3::exception & ) {
+                // decided by other than z3 solver, no model available
+                _model.reset();
+            }
+        }
+
+        /* Remembers the model of a cached satisfiable superset of the query,
+         * it is a witness of the query only once checked by `satisfied`. */
+        bool adopt( const query_cache::entry &e )
+        {
+            if ( !e.has_model )
+                return false;
+
+            auto &ctx = _solver.ctx();
+            z3::model model( ctx );
+            for ( unsigned i = 0; i < e.model_size; ++i ) {
+                const auto &a = e.model[ i ];
+                if ( auto sym = _symbols.find( a.var ); sym != _symbols.end() ) {
+                    auto decl = sym->second.decl();
+                    auto value = ctx.bv_val( a.value, a.bitwidth );
+                    model.add_const_interp( decl, value );
+                }
+            }
+
+            _model = std::move( model );
+            return true;
+        }
+
+        /* Expressions are hash-consed by z3, so the sorted set of their ids
+         * identifies the slice exactly, as long as the expressions are alive.
+         * Constraints are kept by the path, the query by the key's entry. */
+        std::vector< unsigned > slice_key( const std::vector< unsigned > &indices, const z3::expr &query ) const
+        {
+            std::vector< unsigned > key;
+            key.reserve( indices.size() + 1 );
+            for ( auto idx : indices )
+                key.push_back( _constraints[ idx ].expr.id() );
+            key.push_back( query.id() );
+            std::sort( key.begin(), key.end() );
+            key.erase( std::unique( key.begin(), key.end() ), key.end() );
+            return key;
+        }
+
+        /* Hash of the printed constraint together with sorts of its variables,
+         * which do not appear in the printed form. */
+        query_hash canonical_hash( const z3::expr &e, const variables_t &vars )
+        {
+            auto hash = fnv1a( e.to_string() );
+            for ( auto v : vars ) {
+                auto it = _symbols.find( v );
+                if ( it != _symbols.end() )
+                    hash = fnv1a( it->second.get_sort().to_string(), hash ^ v );
+            }
+            return hash;
+        }
+
+        query_key canonical_key( const std::vector< unsigned > &indices,
+                                 const z3::expr &query, const variables_t &vars )
+        {
+            query_key key;
+            key.reserve( indices.size() + 1 );
+            for ( auto idx : indices )
+                key.push_back( _constraints[ idx ].hash );
+            key.push_back( canonical_hash( query, vars ) );
+            std::sort( key.begin(), key.end() );
+            key.erase( std::unique( key.begin(), key.end() ), key.end() );
+            return key;
+        }
+
+        void store( const query_key &key, z3::check_result result,
+                    const std::vector< unsigned > &indices, const variables_t &query_vars )
+        {
+            using status = query_cache::status;
+            if ( result != z3::sat )
+                return _cache->insert( key, status::unsat, std::nullopt );
+            _cache->insert( key, status::sat, assignments( indices, query_vars ) );
+        }
+
+        /* Values of all variables of the slice in the last model, if they fit
+         * in the cache. */
+        std::optional< query_cache::model_t > assignments( const std::vector< unsigned > &indices,
+                                                          const variables_t &query_vars ) const
+        {
+            variables_t vars = query_vars;
+            for ( auto idx : indices )
+                vars.insert( vars.end(), _constraints[ idx ].vars.begin(), _constraints[ idx ].vars.end() );
+            std::sort( vars.begin(), vars.end() );
+            vars.erase( std::unique( vars.begin(), vars.end() ), vars.end() );
+
+            if ( vars.size() > query_cache::max_assignments || !_model )
+                return std::nullopt;
+
+            query_cache::model_t result;
+            const auto &model = *_model;
+            for ( auto v : vars ) {
+                auto sym = _symbols.find( v );
+                if ( sym == _symbols.end() || !sym->second.is_bv() )
+                    return std::nullopt;
+
+                auto width = sym->second.get_sort().bv_size();
+                uint64_t value = 0;
+                if ( width > 64 || !model.eval( sym->second, true ).is_numeral_u64( value ) )
+                    return std::nullopt;
+                result.push_back( { v, uint8_t( width ), value } );
+            }
+            return result;
+        }
+
+        z3::solver _solver;
+        variable_partition _partition;
+        std::vector< constraint > _constraints;
+        // keys are ids of the slice and the query, the query is kept alive by
+        // the value, so that z3 does not reuse its id for another expression
+        std::map< std::vector< unsigned >, z3::expr > _sat_slices;
+        std::optional< z3::model > _model;
+
+        query_cache *_cache = nullptr;
+        solve_t _solve = nullptr;
+        std::unordered_map< unsigned, z3::expr > _symbols;
+    };
+
+} // namespace __lava
@@ -0,0 +1,159 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "tristate.hpp"
+
+namespace sup
+{
+    /* Bits of a fixed-width bit-vector that are known to be zero or one (also
+     * called tristate numbers). A bit known to be both zero and one marks an
+     * empty set of values, i.e., bottom. */
+    struct known_bits
+    {
+        using value_t = uint64_t;
+        using signed_t = int64_t;
+        using width_t = uint8_t;
+
+        value_t zeros = 0, ones = 0;
+        width_t bw = 0;
+
+        constexpr known_bits() = default;
+
+        constexpr known_bits( value_t z, value_t o, width_t w )
+            : zeros( z & mask( w ) ), ones( o & mask( w ) ), bw( w )
+        {}
+
+        static constexpr value_t mask( width_t w )
+        {
+            return w >= 64 ? ~value_t( 0 ) : ( value_t( 1 ) << w ) - 1;
+        }
+
+        static constexpr known_bits top( width_t w ) { return { 0, 0, w }; }
+        static constexpr known_bits bottom( width_t w ) { return { mask( w ), mask( w ), w }; }
+
+        static constexpr known_bits constant( value_t v, width_t w ) { return { ~v, v, w }; }
+
+        /* Bits that are common to all values from `lo` to `hi`. */
+        static constexpr known_bits range( value_t lo, value_t hi, width_t w )
+        {
+            lo &= mask( w );
+            hi &= mask( w );
+            if ( lo > hi )
+                return top( w );
+            auto diff = lo ^ hi;
+            auto common = diff ? ~( ~value_t( 0 ) >> __builtin_clzll( diff ) ) : ~value_t( 0 );
+            return { ~lo & common, lo & common, w };
+        }
+
+        static constexpr known_bits from_bool( bool b ) { return constant( b, 1 ); }
+
+        static constexpr known_bits from_tristate( __lava::tristate t )
+        {
+            if ( __lava::maybe( t ) )
+                return top( 1 );
+            return from_bool( static_cast< bool >( t ) );
+        }
+
+        constexpr value_t known() const { return zeros | ones; }
+        constexpr value_t unknown() const { return ~known() & mask( bw ); }
+
+        constexpr bool is_bottom() const { return zeros & ones; }
+        constexpr bool is_top() const { return known() == 0; }
+        constexpr bool is_constant() const { return !is_bottom() && known() == mask( bw ); }
+
+        constexpr value_t sign() const { return value_t( 1 ) << ( bw - 1 ); }
+
+        constexpr signed_t to_signed( value_t v ) const
+        {
+            auto shift = 64 - bw;
+            return signed_t( v << shift ) >> shift;
+        }
+
+        constexpr value_t umin() const { return ones; }
+        constexpr value_t umax() const { return ~zeros & mask( bw ); }
+
+        constexpr signed_t smin() const { return to_signed( ones | ( unknown() & sign() ) ); }
+        constexpr signed_t smax() const { return to_signed( umax() & ~( unknown() & sign() ) ); }
+
+        constexpr bool contains( value_t v ) const
+        {
+            return ( v & zeros ) == 0 && ( v & ones ) == ones;
+        }
+
+        /* Number of consecutive known zeros starting from the least significant bit. */
+        constexpr unsigned trailing_zeros() const
+        {
+            auto z = ~zeros & mask( bw );
+            return z ? unsigned( __builtin_ctzll( z ) ) : bw;
+        }
+
+        /* Number of consecutive known bits starting from the least significant bit. */
+        constexpr unsigned trailing_known() const
+        {
+            auto u = unknown();
+            return u ? unsigned( __builtin_ctzll( u ) ) : bw;
+        }
+
+        /* Number of consecutive known zeros starting from the most significant bit. */
+        constexpr unsigned leading_zeros() const
+        {
+            auto z = ~zeros & mask( bw );
+            return z ? unsigned( __builtin_clzll( z ) ) - ( 64u - bw ) : bw;
+        }
+
+        /* Number of consecutive known ones starting from the most significant bit. */
+        constexpr unsigned leading_ones() const
+        {
+            auto o = ~ones & mask( bw );
+            return o ? unsigned( __builtin_clzll( o ) ) - ( 64u - bw ) : bw;
+        }
+
+        explicit constexpr operator __lava::tristate() const noexcept
+        {
+            if ( ones )
+                return __lava::tristate( true );
+            if ( zeros == mask( bw ) )
+                return __lava::tristate( false );
+            return __lava::tristate( __lava::maybe );
+        }
+
+        friend constexpr known_bits join( const known_bits &a, const known_bits &b )
+        {
+            if ( a.is_bottom() )
+                return b;
+            if ( b.is_bottom() )
+                return a;
+            return { a.zeros & b.zeros, a.ones & b.ones, a.bw };
+        }
+
+        friend constexpr known_bits meet( const known_bits &a, const known_bits &b )
+        {
+            return { a.zeros | b.zeros, a.ones | b.ones, a.bw };
+        }
+
+        constexpr bool operator==( const known_bits &o ) const
+        {
+            if ( is_bottom() || o.is_bottom() )
+                return is_bottom() == o.is_bottom() && bw == o.bw;
+            return zeros == o.zeros && ones == o.ones && bw == o.bw;
+        }
+    };
+
+} // namespace sup
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <cstdlib>
 #include <memory>
+#include <type_traits>
 #include <sys/mman.h>
 
 namespace __lava {
@@ -46,4 +48,21 @@ namespace __lava {
         std::abort();
     }
 
+    /* Maps an object shared with forked children, optionally backed by a file
+     * descriptor. The object is not constructed, its type has to be valid when
+     * zero-filled (fresh mapping) or as previously left in the backing file. */
+    template< typename T >
+    unique_mapped_ptr< T > make_mmap_shared( int fd = -1 )
+    {
+        static_assert( std::is_trivially_destructible_v< T > );
+
+        constexpr auto PROT_RW = PROT_READ | PROT_WRITE;
+        auto flags = fd == -1 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+
+        auto ptr = mmap( NULL, sizeof( T ), PROT_RW, flags, fd, 0 );
+        if ( ptr == MAP_FAILED )
+            std::abort();
+        return unique_mapped_ptr< T >( static_cast< T * >( ptr ) );
+    }
+
 } // namespace __lava
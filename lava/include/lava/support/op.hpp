@@ -56,6 +56,10 @@ namespace __lava
         template< typename size >
         static optag op_alloca( const size&, uint8_t ) { return tag::alloca; }
 
+        /* widened value has no operands to propagate constraints to */
+        static optag op_widen( ref, ref ) { return tag::widen; }
+        static bool subsumes( ref, ref ) { return true; }
+
         static void assume( ref, bool ) {}
 
         static tristate to_tristate( ref ) { return mixin::fail("unsupported"); }
@@ -24,7 +24,7 @@ namespace __lava::op
     {
         unknown,
         any, lift, lower,
-        join, meet,
+        join, meet, widen,
 
         alloca, store, load,
 
@@ -63,6 +63,7 @@ namespace __lava::op
             case tag::lower: return "lower";
             case tag::join:  return "join";
             case tag::meet:  return "meet";
+            case tag::widen: return "widen";
 
             case tag::alloca: return "alloca";
             case tag::store:  return "store";
@@ -156,6 +157,7 @@ namespace __lava::op
 
     static constexpr auto join = []( const auto &a ) { return std::decay_t< decltype( a ) >::op_join; };
     static constexpr auto meet = []( const auto &a ) { return std::decay_t< decltype( a ) >::op_meet; };
+    static constexpr auto widen = []( const auto &a ) { return std::decay_t< decltype( a ) >::op_widen; };
 
     static constexpr auto add = []( const auto &a ) { return std::decay_t< decltype( a ) >::op_add; };
     static constexpr auto sub = []( const auto &a ) { return std::decay_t< decltype( a ) >::op_sub; };
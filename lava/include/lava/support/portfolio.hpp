@@ -0,0 +1,291 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/mmaped_pointer.hpp>
+#include <lava/term.hpp>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <cvc5/cvc5.h>
+#include <z3++.h>
+
+namespace __lava
+{
+    namespace cvc = cvc5::api;
+
+    /* Translation of z3 bit-vector formulas to cvc5 terms. Only the fragment
+     * produced by the term domain is supported, anything else is reported as
+     * unsupported and the query is left to z3 alone. */
+    struct z3_to_cvc
+    {
+        struct unsupported {};
+
+        explicit z3_to_cvc( cvc::Solver &solver ) : _solver( solver ) {}
+
+        cvc::Term operator()( const z3::expr &e )
+        {
+            if ( auto it = _cache.find( e.id() ); it != _cache.end() )
+                return it->second;
+
+            auto t = translate( e );
+            _cache.emplace( e.id(), t );
+            return t;
+        }
+
+    private:
+        cvc::Sort sort( const z3::sort &s )
+        {
+            if ( s.is_bool() )
+                return _solver.getBooleanSort();
+            if ( s.is_bv() )
+                return _solver.mkBitVectorSort( s.bv_size() );
+            throw unsupported{};
+        }
+
+        cvc::Term translate( const z3::expr &e )
+        {
+            if ( !e.is_app() )
+                throw unsupported{};
+
+            std::vector< cvc::Term > args;
+            for ( unsigned i = 0; i < e.num_args(); ++i )
+                args.push_back( ( *this )( e.arg( i ) ) );
+
+            auto decl = e.decl();
+            auto param = [&] ( unsigned idx ) {
+                return unsigned( Z3_get_decl_int_parameter( e.ctx(), decl, idx ) );
+            };
+
+            auto mk = [&] ( cvc::Kind kind ) { return _solver.mkTerm( kind, args ); };
+
+            switch ( decl.decl_kind() )
+            {
+                case Z3_OP_UNINTERPRETED:
+                    if ( e.num_args() != 0 )
+                        throw unsupported{};
+                    return _solver.mkConst( sort( e.get_sort() ), decl.name().str() );
+
+                case Z3_OP_TRUE:  return _solver.mkTrue();
+                case Z3_OP_FALSE: return _solver.mkFalse();
+
+                case Z3_OP_BNUM:
+                    return _solver.mkBitVector( e.get_sort().bv_size(), e.get_decimal_string( 0 ), 10 );
+
+                case Z3_OP_EQ:       return mk( cvc::EQUAL );
+                case Z3_OP_DISTINCT: return mk( cvc::DISTINCT );
+                case Z3_OP_ITE:      return mk( cvc::ITE );
+                case Z3_OP_AND:      return mk( cvc::AND );
+                case Z3_OP_OR:       return mk( cvc::OR );
+                case Z3_OP_XOR:      return mk( cvc::XOR );
+                case Z3_OP_NOT:      return mk( cvc::NOT );
+                case Z3_OP_IMPLIES:  return mk( cvc::IMPLIES );
+
+                case Z3_OP_BNEG: return mk( cvc::BITVECTOR_NEG );
+                case Z3_OP_BADD: return mk( cvc::BITVECTOR_ADD );
+                case Z3_OP_BSUB: return mk( cvc::BITVECTOR_SUB );
+                case Z3_OP_BMUL: return mk( cvc::BITVECTOR_MULT );
+
+                case Z3_OP_BSDIV: case Z3_OP_BSDIV_I: return mk( cvc::BITVECTOR_SDIV );
+                case Z3_OP_BUDIV: case Z3_OP_BUDIV_I: return mk( cvc::BITVECTOR_UDIV );
+                case Z3_OP_BSREM: case Z3_OP_BSREM_I: return mk( cvc::BITVECTOR_SREM );
+                case Z3_OP_BUREM: case Z3_OP_BUREM_I: return mk( cvc::BITVECTOR_UREM );
+                case Z3_OP_BSMOD: case Z3_OP_BSMOD_I: return mk( cvc::BITVECTOR_SMOD );
+
+                case Z3_OP_ULEQ: return mk( cvc::BITVECTOR_ULE );
+                case Z3_OP_SLEQ: return mk( cvc::BITVECTOR_SLE );
+                case Z3_OP_UGEQ: return mk( cvc::BITVECTOR_UGE );
+                case Z3_OP_SGEQ: return mk( cvc::BITVECTOR_SGE );
+                case Z3_OP_ULT:  return mk( cvc::BITVECTOR_ULT );
+                case Z3_OP_SLT:  return mk( cvc::BITVECTOR_SLT );
+                case Z3_OP_UGT:  return mk( cvc::BITVECTOR_UGT );
+                case Z3_OP_SGT:  return mk( cvc::BITVECTOR_SGT );
+
+                case Z3_OP_BAND:  return mk( cvc::BITVECTOR_AND );
+                case Z3_OP_BOR:   return mk( cvc::BITVECTOR_OR );
+                case Z3_OP_BNOT:  return mk( cvc::BITVECTOR_NOT );
+                case Z3_OP_BXOR:  return mk( cvc::BITVECTOR_XOR );
+                case Z3_OP_BNAND: return mk( cvc::BITVECTOR_NAND );
+                case Z3_OP_BNOR:  return mk( cvc::BITVECTOR_NOR );
+                case Z3_OP_BXNOR: return mk( cvc::BITVECTOR_XNOR );
+                case Z3_OP_BCOMP: return mk( cvc::BITVECTOR_COMP );
+
+                case Z3_OP_BSHL:  return mk( cvc::BITVECTOR_SHL );
+                case Z3_OP_BLSHR: return mk( cvc::BITVECTOR_LSHR );
+                case Z3_OP_BASHR: return mk( cvc::BITVECTOR_ASHR );
+
+                case Z3_OP_CONCAT: return mk( cvc::BITVECTOR_CONCAT );
+
+                case Z3_OP_EXTRACT:
+                    return _solver.mkTerm( _solver.mkOp( cvc::BITVECTOR_EXTRACT, param( 0 ), param( 1 ) ), args );
+                case Z3_OP_ZERO_EXT:
+                    return _solver.mkTerm( _solver.mkOp( cvc::BITVECTOR_ZERO_EXTEND, param( 0 ) ), args );
+                case Z3_OP_SIGN_EXT:
+                    return _solver.mkTerm( _solver.mkOp( cvc::BITVECTOR_SIGN_EXTEND, param( 0 ) ), args );
+
+                default:
+                    throw unsupported{};
+            }
+        }
+
+        cvc::Solver &_solver;
+        std::unordered_map< unsigned, cvc::Term > _cache;
+    };
+
+    /* Win statistics are shared by all processes of the exploration and
+     * reported by the process that started it. The mapping is never released,
+     * the report runs from an exit handler after globals are destroyed. */
+    struct portfolio_stats
+    {
+        pid_t root;
+        uint64_t z3_wins;
+        uint64_t cvc5_wins;
+    };
+
+    portfolio_stats *__portfolio_stats = nullptr;
+
+    namespace detail
+    {
+        enum portfolio_answer : char { answer_sat = 's', answer_unsat = 'u', answer_unknown = '?' };
+
+        /* Body of the forked cvc5 racer, the process is killed once z3 wins. */
+        [[noreturn]] inline void portfolio_cvc5( const z3::solver &solver, int out )
+        {
+            char answer = answer_unknown;
+            try {
+                cvc::Solver slv;
+                slv.setLogic( "QF_BV" );
+
+                z3_to_cvc translate( slv );
+                for ( const auto &assertion : solver.assertions() )
+                    slv.assertFormula( translate( assertion ) );
+
+                auto result = slv.checkSat();
+                if ( result.isSat() )
+                    answer = answer_sat;
+                else if ( result.isUnsat() )
+                    answer = answer_unsat;
+            } catch ( ... ) {
+                // unsupported formula or solver error, leave it to z3
+            }
+
+            [[maybe_unused]] auto written = write( out, &answer, 1 );
+            _exit( 0 );
+        }
+    } // namespace detail
+
+    /* Races z3 (on the calling thread) with cvc5 on the assertions of the
+     * solver and returns the first definite answer.
+     *
+     * cvc5 runs in a forked process: it cannot be interrupted through its API
+     * and the exploration itself forks, so a helper thread would not survive
+     * in children anyway. The fork happens before any thread is started, the
+     * child translates the z3 assertions from its copy of the context. A
+     * watcher thread interrupts z3 when cvc5 answers first, otherwise the
+     * cvc5 process is killed. */
+    inline z3::check_result portfolio_check( z3::solver &solver )
+    {
+        int fds[ 2 ];
+        if ( pipe( fds ) != 0 )
+            return solver.check();
+
+        auto pid = fork();
+        if ( pid == -1 ) {
+            close( fds[ 0 ] );
+            close( fds[ 1 ] );
+            return solver.check();
+        }
+
+        if ( pid == 0 ) {
+            close( fds[ 0 ] );
+            detail::portfolio_cvc5( solver, fds[ 1 ] );
+        }
+
+        close( fds[ 1 ] );
+
+        std::mutex mutex;
+        bool z3_running = true;
+        char cvc5_answer = detail::answer_unknown;
+
+        std::thread watcher( [&] {
+            char answer = detail::answer_unknown;
+            pollfd pfd{ fds[ 0 ], POLLIN, 0 };
+            if ( poll( &pfd, 1, -1 ) <= 0 || read( fds[ 0 ], &answer, 1 ) != 1 )
+                return; // killed or crashed
+
+            std::lock_guard lock( mutex );
+            if ( !z3_running || answer == detail::answer_unknown )
+                return;
+            cvc5_answer = answer;
+            solver.ctx().interrupt();
+        } );
+
+        // an exceeded limit may throw, the helper is cleaned up regardless
+        auto result = z3::unknown;
+        try {
+            result = solver.check();
+        } catch ( z3::exception & ) {}
+
+        {
+            std::lock_guard lock( mutex );
+            z3_running = false;
+        }
+
+        kill( pid, SIGKILL );
+        watcher.join();
+        waitpid( pid, nullptr, 0 );
+        close( fds[ 0 ] );
+
+        if ( cvc5_answer != detail::answer_unknown ) {
+            ++__portfolio_stats->cvc5_wins;
+            return cvc5_answer == detail::answer_sat ? z3::sat : z3::unsat;
+        }
+
+        if ( result != z3::unknown )
+            ++__portfolio_stats->z3_wins;
+        return result;
+    }
+
+    inline void portfolio_report()
+    {
+        if ( !__portfolio_stats || __portfolio_stats->root != getpid() )
+            return;
+        fprintf( stderr, "[term portfolio] z3 wins: %lu, cvc5 wins: %lu\n",
+                 __portfolio_stats->z3_wins, __portfolio_stats->cvc5_wins );
+    }
+
+    /* Installs the portfolio into the term domain, hence has to run after
+     * `term_setup`. */
+    [[gnu::constructor( 102 )]] void portfolio_setup()
+    {
+        fprintf( stderr, "[term config] solver portfolio z3, cvc5\n" );
+        __portfolio_stats = make_mmap_shared< portfolio_stats >().release();
+        __portfolio_stats->root = getpid();
+        __term_state->path.solve( portfolio_check );
+        std::atexit( portfolio_report );
+    }
+
+} // namespace __lava
@@ -42,15 +42,26 @@ namespace __lava
     struct to_tristate_first {};
     struct to_tristate_second {};
     struct to_tristate_disabled {};
+    struct to_tristate_either {}; // first, unless it is undecided
+
+    /* Reduction exchanges information between the components of a product,
+     * it is applied to each value produced or refined by the product. */
+    struct no_reduction
+    {
+        template< typename A, typename B >
+        static constexpr void reduce( A &, B & ) {}
+    };
 
     template<
         typename lowering_strategy_t,
-        typename to_tristate_strategy_t
+        typename to_tristate_strategy_t,
+        typename reduction_t = no_reduction
     >
     struct product_config
     {
         using lowering_strategy = lowering_strategy_t;
         using to_tristate_strategy = to_tristate_strategy_t;
+        using reduction = reduction_t;
     };
 
     using default_product_config = product_config<
@@ -104,15 +115,33 @@ namespace __lava
                 return A::to_tristate( v->first );
             if constexpr ( std::is_same_v< typename config::to_tristate_strategy, to_tristate_second > )
                 return B::to_tristate( v->second );
+            if constexpr ( std::is_same_v< typename config::to_tristate_strategy, to_tristate_either > ) {
+                auto t = A::to_tristate( v->first );
+                return maybe( t ) ? B::to_tristate( v->second ) : t;
+            }
             mixin::fail( "to_tristate is disabled" );
         }
 
         static constexpr auto wrap = __lava::op::wrap;
 
+        static void reduce( product &v )
+        {
+            config::reduction::reduce( v->first, v->second );
+        }
+
+        static pv reduced( pv &&v )
+        {
+            reduce( v );
+            return std::move( v );
+        }
+
+        /* backward operations refine their arguments in place, like domain_ref */
+        static void refined( pr v ) { reduce( const_cast< product & >( v ) ); }
+
         template< typename op_t >
         static constexpr pv bin( op_t op, pr a, pr b )
         {
-            return { op( a->first, b->first ), op( a->second, b->second ) };
+            return reduced( { op( a->first, b->first ), op( a->second, b->second ) } );
         }
 
         template< typename op_t >
@@ -120,12 +149,14 @@ namespace __lava
         {
             op( r->first, a->first, b->first );
             op( r->second, a->second, b->second );
+            refined( a );
+            refined( b );
         }
 
         template< typename op_t >
         static constexpr pv un( op_t op, pr a )
         {
-            return { op( a->first ), op( a->second ) };
+            return reduced( { op( a->first ), op( a->second ) } );
         }
 
         template< typename op_t >
@@ -133,6 +164,7 @@ namespace __lava
         {
             op( r->first, a->first );
             op( r->second, a->second );
+            refined( a );
         }
 
 
@@ -140,7 +172,7 @@ namespace __lava
 
         template< typename type > static pv lift( const type &value )
         {
-            return { A::lift( value ), B::lift( value ) };
+            return reduced( { A::lift( value ), B::lift( value ) } );
         }
 
         // template< typename X, typename Y, typename orig_config >
@@ -151,17 +183,17 @@ namespace __lava
 
         template< typename type > static pv any()
         {
-            return { A::template any< type >(), B::template any< type >() };
+            return reduced( { A::template any< type >(), B::template any< type >() } );
         }
 
         template< typename type > static pv any(const variadic_list &args)
         {
-            return { A::template any< type >(args), B::template any< type >(args) };
+            return reduced( { A::template any< type >(args), B::template any< type >(args) } );
         }
 
         template< typename type > static pv any(type from, type to)
         {
-            return { A::any(from, to), B::any(from, to) };
+            return reduced( { A::any(from, to), B::any(from, to) } );
         }
 
         // template< typename op_t >
@@ -184,6 +216,12 @@ namespace __lava
 
         static pv op_join( pr a, pr b ) { return bin( wrap( op::join ), a, b ); }
         static pv op_meet( pr a, pr b ) { return bin( wrap( op::meet ), a, b ); }
+        static pv op_widen( pr a, pr b ) { return bin( wrap( op::widen ), a, b ); }
+
+        static bool subsumes( pr a, pr b )
+        {
+            return A::subsumes( a->first, b->first ) && B::subsumes( a->second, b->second );
+        }
 
         static pv op_add ( pr a, pr b ) { return bin( wrap( op::add ), a, b ); }
         static pv op_sub ( pr a, pr b ) { return bin( wrap( op::sub ), a, b ); }
@@ -268,6 +306,7 @@ namespace __lava
             auto op = op::wrapr( op::assume, c );
             op( a->first );
             op( a->second );
+            reduce( a );
         }
 
         static void dump( pr /* a */ )
@@ -0,0 +1,217 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/mmaped_pointer.hpp>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace __lava
+{
+    using query_hash = uint64_t;
+
+    constexpr query_hash fnv1a( std::string_view str, query_hash hash = 14695981039346656037ull )
+    {
+        for ( char c : str ) {
+            hash ^= query_hash( static_cast< unsigned char >( c ) );
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /* Sorted and deduplicated canonical hashes of constraints in a query. */
+    using query_key = std::vector< query_hash >;
+
+    struct query_assignment
+    {
+        uint32_t var;
+        uint8_t bitwidth;
+        uint64_t value;
+    };
+
+    /* Results of satisfiability queries shared by all processes of a single
+     * exploration (and optionally across runs through a backing file).
+     *
+     * Queries are sets of constraints, which allows to answer queries that
+     * were never solved directly: any superset of an unsatisfiable set is
+     * unsatisfiable and any subset of a satisfiable set is satisfiable, the
+     * model of the superset being its witness.
+     *
+     * Forked children are executed one at a time while the parent waits, but
+     * a cache backed by a file may be shared by independent explorations, so
+     * each access holds an exclusive `flock` of the file. The layout has to
+     * stay valid when zero-filled, see `make_mmap_shared`. */
+    struct query_cache
+    {
+        static constexpr uint32_t magic_value     = 0x6c717263; // "lqrc"
+        static constexpr uint32_t layout_version  = 1;
+        static constexpr unsigned capacity        = 4096;
+        static constexpr unsigned max_constraints = 32;
+        static constexpr unsigned max_assignments = 16;
+
+        enum class status : uint8_t { empty = 0, sat, unsat };
+
+        using model_t = std::vector< query_assignment >;
+
+        struct entry
+        {
+            status result;
+            uint8_t size;
+            uint8_t model_size;
+            bool has_model;
+            uint64_t signature;
+            query_hash constraints[ max_constraints ];
+            query_assignment model[ max_assignments ];
+
+            const query_hash *begin() const { return constraints; }
+            const query_hash *end() const { return constraints + size; }
+        };
+
+        /* Holds the lock of the backing file, if there is one. Forked
+         * children share the open file (and hence the lock) with the parent,
+         * which is fine as they do not run concurrently. */
+        struct guard
+        {
+            guard() { if ( fd != -1 ) flock( fd, LOCK_EX ); }
+            ~guard() { if ( fd != -1 ) flock( fd, LOCK_UN ); }
+        };
+
+        // backing file of the cache in this process
+        static inline int fd = -1;
+
+        static uint64_t signature( const query_key &key )
+        {
+            uint64_t sig = 0;
+            for ( auto h : key )
+                sig |= uint64_t( 1 ) << ( h & 63 );
+            return sig;
+        }
+
+        /* Finds an entry that decides the query: either an unsatisfiable
+         * subset or a satisfiable superset (or the query itself). The entry
+         * is copied, another process may overwrite it once the lock is
+         * released. */
+        std::optional< entry > lookup( const query_key &key )
+        {
+            guard lock;
+            auto sig = signature( key );
+            auto used = std::min( count, capacity );
+
+            for ( unsigned i = 0; i < used; ++i ) {
+                const auto &e = entries[ i ];
+                if ( e.result == status::unsat && ( e.signature & ~sig ) == 0 ) {
+                    if ( std::includes( key.begin(), key.end(), e.begin(), e.end() ) ) {
+                        ++hits;
+                        return e;
+                    }
+                }
+
+                if ( e.result == status::sat && ( sig & ~e.signature ) == 0 ) {
+                    if ( std::includes( e.begin(), e.end(), key.begin(), key.end() ) ) {
+                        ++hits;
+                        return e;
+                    }
+                }
+            }
+
+            ++misses;
+            return std::nullopt;
+        }
+
+        /* Satisfiable queries come with the model of their variables, unless
+         * it could not be represented. */
+        void insert( const query_key &key, status result, const std::optional< model_t > &model )
+        {
+            if ( key.size() > max_constraints )
+                return;
+            bool has_model = model && model->size() <= max_assignments;
+
+            guard lock;
+            auto &e = entries[ count++ % capacity ];
+            e.result = result;
+            e.size = uint8_t( key.size() );
+            e.model_size = has_model ? uint8_t( model->size() ) : 0;
+            e.has_model = has_model;
+            e.signature = signature( key );
+            std::copy( key.begin(), key.end(), e.constraints );
+            if ( has_model )
+                std::copy( model->begin(), model->end(), e.model );
+        }
+
+        bool valid() const
+        {
+            return magic == magic_value && version == layout_version
+                && entry_size == sizeof( entry ) && entry_count == capacity;
+        }
+
+        // header, a mismatch (e.g., a file of another build) resets the cache
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entry_size;
+        uint32_t entry_count;
+
+        unsigned count;
+        uint64_t hits;
+        uint64_t misses;
+        entry entries[ capacity ];
+    };
+
+    /* Maps the query cache shared with forked children. If a path is given,
+     * the cache is backed by that file and persists between runs. */
+    inline unique_mapped_ptr< query_cache > map_query_cache( const char *path )
+    {
+        int fd = -1;
+        if ( path ) {
+            fd = open( path, O_RDWR | O_CREAT, 0644 );
+            if ( fd != -1 )
+                flock( fd, LOCK_EX );
+            if ( fd == -1 || ftruncate( fd, sizeof( query_cache ) ) != 0 ) {
+                fprintf( stderr, "[term config] unable to open query cache %s\n", path );
+                if ( fd != -1 )
+                    close( fd );
+                fd = -1;
+            }
+        }
+
+        auto cache = make_mmap_shared< query_cache >( fd );
+
+        if ( !cache->valid() ) {
+            std::memset( cache.get(), 0, sizeof( query_cache ) );
+            cache->magic = query_cache::magic_value;
+            cache->version = query_cache::layout_version;
+            cache->entry_size = sizeof( query_cache::entry );
+            cache->entry_count = query_cache::capacity;
+        }
+
+        // the file stays open for locking
+        if ( fd != -1 )
+            flock( fd, LOCK_UN );
+        query_cache::fd = fd;
+        return cache;
+    }
+
+} // namespace __lava
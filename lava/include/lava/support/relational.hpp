@@ -24,6 +24,8 @@
 #include <lava/support/history.hpp>
 #include <lava/support/product.hpp>
 
+#include <lamp/support/storage.hpp>
+
 namespace __lava
 {
     using config = __lava::product_config< __lava::lower_first, __lava::to_tristate_first >;
@@ -32,9 +34,9 @@ namespace __lava
     using tagged = product< domain, optag< storage >, storage, config >;
 
     template< typename domain, template< typename > typename storage >
-    struct relational : with_history< tagged< domain, storage >, storage >
+    struct relational : with_history< tagged< domain, storage >, __lamp::arena_storage >
     {
-        using base  = with_history< tagged< domain, storage >, storage >;
+        using base  = with_history< tagged< domain, storage >, __lamp::arena_storage >;
         using mixin = domain_mixin< relational >;
 
         using optag = typename tagged< domain, storage >::right_type;
@@ -59,12 +61,12 @@ namespace __lava
         constexpr op::tag tag() const
         {
             const auto &tagged = underlying()->value;
-            return tagged->right()->value;
+            return tagged.right()->value;
         }
 
         constexpr void* arg(unsigned idx) const
         {
-            return underlying()->children[idx];
+            return underlying()->children()[idx];
         }
 
         template< typename type >
@@ -111,6 +113,7 @@ namespace __lava
 
                 case op::tag::join: mixin::fail("unsupported join bop"); return;
                 case op::tag::meet: mixin::fail("unsupported meet bop"); return;
+                case op::tag::widen: return;
 
                 case op::tag::alloca: mixin::fail("unsupported alloca bop"); return;
                 case op::tag::store:  mixin::fail("unsupported store bop"); return;
@@ -196,7 +199,7 @@ namespace __lava
                 case op::tag::free: mixin::fail("unsupported free bop"); return;
             }
 
-            for (const auto &ch : a.underlying()->children) {
+            for (auto ch : a.underlying()->children()) {
                 using rel_ref = domain_ref< self >;
                 backward_propagate( rel_ref(ch) );
             }
@@ -207,6 +210,9 @@ namespace __lava
             return base::to_tristate( a );
         }
 
+        static self op_widen( sref a, sref b ) { return base::op_widen( a, b ); }
+        static bool subsumes( sref a, sref b ) { return base::subsumes( a, b ); }
+
         /* arithmetic operations */
         static self op_add ( sref a, sref b ) { return base::op_add( a, b ); }
         static self op_fadd( sref a, sref b ) { return base::op_fadd( a, b ); }
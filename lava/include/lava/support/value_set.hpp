@@ -0,0 +1,222 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "interval.hpp"
+#include "tristate.hpp"
+
+namespace sup
+{
+    /* Finite set of integers kept sorted and unique in a small inline array.
+     * Sets with more than `capacity` elements are approximated by their
+     * convex hull (the set is `wide`), the hull is maintained in both cases. */
+    struct value_set
+    {
+        static constexpr unsigned capacity = 8;
+
+        using value_t = int64_t;
+        using bound_t = bound< value_t >;
+        using interval_t = interval< bound_t >;
+
+        std::array< value_t, capacity > values{};
+        uint8_t count = 0;
+        bool wide = false;
+        interval_t hull = interval_t::bottom();
+
+        static value_set bottom() { return {}; }
+
+        static value_set top() { return wrap( interval_t::top() ); }
+
+        static value_set constant( value_t v )
+        {
+            value_set res;
+            res.values[ 0 ] = v;
+            res.count = 1;
+            res.hull = { v, v };
+            return res;
+        }
+
+        static value_set wrap( const interval_t &i )
+        {
+            if ( i.is_bottom() )
+                return bottom();
+            value_set res;
+            res.wide = true;
+            res.hull = i;
+            return res;
+        }
+
+        /* Enumerates small finite intervals. */
+        static value_set from_interval( const interval_t &i )
+        {
+            if ( i.is_bottom() || i.is_infinite() || i.size() > capacity )
+                return wrap( i );
+            value_set res;
+            for ( auto v = value_t( i.low ); v <= value_t( i.high ); ++v )
+                res.values[ res.count++ ] = v;
+            res.hull = i;
+            return res;
+        }
+
+        /* Sorts and deduplicates values in place. */
+        static value_set from_values( value_t *first, value_t *last )
+        {
+            if ( first == last )
+                return bottom();
+            std::sort( first, last );
+            last = std::unique( first, last );
+
+            auto n = unsigned( last - first );
+            if ( n > capacity )
+                return wrap( { *first, *( last - 1 ) } );
+
+            value_set res;
+            std::copy( first, last, res.values.begin() );
+            res.count = uint8_t( n );
+            res.hull = { *first, *( last - 1 ) };
+            return res;
+        }
+
+        static value_set from_bool( bool b ) { return constant( b ); }
+
+        static value_set from_tristate( __lava::tristate t )
+        {
+            if ( __lava::maybe( t ) )
+                return from_interval( { 0, 1 } );
+            return from_bool( static_cast< bool >( t ) );
+        }
+
+        constexpr bool is_bottom() const { return !wide && count == 0; }
+        constexpr bool is_exact() const { return !wide; }
+        constexpr bool is_constant() const { return !wide && count == 1; }
+        constexpr bool is_top() const { return wide && hull.is_top(); }
+
+        const value_t *begin() const { return values.data(); }
+        const value_t *end() const { return values.data() + count; }
+
+        value_t min() const { return value_t( hull.low ); }
+        value_t max() const { return value_t( hull.high ); }
+
+        bool contains( value_t v ) const
+        {
+            return wide ? hull.includes( bound_t( v ) ) : std::binary_search( begin(), end(), v );
+        }
+
+        bool includes( const value_set &o ) const
+        {
+            if ( o.is_bottom() )
+                return true;
+            if ( wide )
+                return hull.includes( o.hull );
+            return !o.wide && std::includes( begin(), end(), o.begin(), o.end() );
+        }
+
+        /* Keeps the values that satisfy the predicate. */
+        template< typename pred >
+        value_set filter( pred p ) const
+        {
+            std::array< value_t, capacity > buf;
+            unsigned n = 0;
+            for ( auto v : *this )
+                if ( p( v ) )
+                    buf[ n++ ] = v;
+            return from_values( buf.data(), buf.data() + n );
+        }
+
+        value_set intersect( const interval_t &i ) const
+        {
+            if ( wide )
+                return from_interval( meet( hull, i ) );
+            return filter( [&] ( value_t v ) { return i.includes( bound_t( v ) ); } );
+        }
+
+        /* Removes a single value, wide sets shrink only at the ends. */
+        value_set exclude( value_t v ) const
+        {
+            if ( wide )
+                return from_interval( hull.exclude( bound_t( v ) ) );
+            return filter( [v] ( value_t x ) { return x != v; } );
+        }
+
+        /* Applies `op` to all pairs of values of exact sets. The loops are
+         * branch-free over a fixed-size buffer, so they vectorize. */
+        template< typename op >
+        static value_set pairwise( const value_set &a, const value_set &b, op f )
+        {
+            std::array< value_t, capacity * capacity > buf;
+            unsigned n = 0;
+            for ( auto x : a ) {
+                auto out = buf.data() + n;
+                for ( unsigned j = 0; j < b.count; ++j )
+                    out[ j ] = f( x, b.values[ j ] );
+                n += b.count;
+            }
+            return from_values( buf.data(), buf.data() + n );
+        }
+
+        explicit operator __lava::tristate() const noexcept
+        {
+            if ( wide )
+                return static_cast< __lava::tristate >( hull );
+            if ( is_constant() )
+                return __lava::tristate( values[ 0 ] != 0 );
+            return contains( 0 ) ? __lava::tristate( __lava::maybe ) : __lava::tristate( true );
+        }
+
+        friend value_set join( const value_set &a, const value_set &b )
+        {
+            if ( a.is_bottom() )
+                return b;
+            if ( b.is_bottom() )
+                return a;
+            if ( a.wide || b.wide )
+                return wrap( join( a.hull, b.hull ) );
+
+            std::array< value_t, 2 * capacity > buf;
+            auto last = std::merge( a.begin(), a.end(), b.begin(), b.end(), buf.begin() );
+            return from_values( buf.data(), buf.data() + ( last - buf.begin() ) );
+        }
+
+        friend value_set meet( const value_set &a, const value_set &b )
+        {
+            if ( a.wide && b.wide )
+                return from_interval( meet( a.hull, b.hull ) );
+            if ( a.wide )
+                return b.intersect( a.hull );
+            if ( b.wide )
+                return a.intersect( b.hull );
+
+            std::array< value_t, capacity > buf;
+            auto last = std::set_intersection( a.begin(), a.end(), b.begin(), b.end(), buf.begin() );
+            return from_values( buf.data(), buf.data() + ( last - buf.begin() ) );
+        }
+
+        bool operator==( const value_set &o ) const
+        {
+            if ( wide != o.wide )
+                return false;
+            if ( wide )
+                return hull.low == o.hull.low && hull.high == o.hull.high;
+            return std::equal( begin(), end(), o.begin(), o.end() );
+        }
+    };
+
+} // namespace sup
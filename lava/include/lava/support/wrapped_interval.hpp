@@ -0,0 +1,302 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "tristate.hpp"
+
+namespace sup
+{
+    /* At most two contiguous pieces of a wrapped interval in either unsigned
+     * or signed order. */
+    template< typename value_t >
+    struct pieces
+    {
+        using piece = std::pair< value_t, value_t >;
+
+        void push( value_t lo, value_t hi ) { _items[ _size++ ] = { lo, hi }; }
+
+        const piece *begin() const { return _items; }
+        const piece *end() const { return _items + _size; }
+
+        bool empty() const { return _size == 0; }
+
+    private:
+        piece _items[ 2 ];
+        unsigned _size = 0;
+    };
+
+    /* Interval on the circle of bit-vectors of a fixed width: the values from
+     * `left` to `right` going up and wrapping around from the maximal value
+     * to zero. Wrapped intervals are signedness agnostic, the same interval
+     * is contiguous either in unsigned or in signed order (or both), see
+     * Gange et al., Interval Analysis and Machine Arithmetic. */
+    struct wrapped_interval
+    {
+        using value_t = uint64_t;
+        __extension__ typedef __int128 wide_t;
+        __extension__ typedef unsigned __int128 uwide_t;
+        using width_t = uint8_t;
+
+        enum class kind : uint8_t { bottom, range, top };
+
+        value_t left = 0, right = 0;
+        width_t bw = 0;
+        kind k = kind::bottom;
+
+        constexpr wrapped_interval() = default;
+
+        constexpr wrapped_interval( value_t l, value_t r, width_t w )
+            : left( l & mask( w ) ), right( r & mask( w ) ), bw( w ), k( kind::range )
+        {
+            if ( cardinality() == modulus( w ) )
+                *this = top( w );
+        }
+
+        static constexpr value_t mask( width_t w )
+        {
+            return w >= 64 ? ~value_t( 0 ) : ( value_t( 1 ) << w ) - 1;
+        }
+
+        static constexpr uwide_t modulus( width_t w ) { return uwide_t( 1 ) << w; }
+
+        static constexpr wrapped_interval top( width_t w )
+        {
+            wrapped_interval i;
+            i.left = 0;
+            i.right = mask( w );
+            i.bw = w;
+            i.k = kind::top;
+            return i;
+        }
+
+        static constexpr wrapped_interval bottom( width_t w )
+        {
+            wrapped_interval i;
+            i.bw = w;
+            return i;
+        }
+
+        static constexpr wrapped_interval constant( value_t v, width_t w ) { return { v, v, w }; }
+
+        /* Values between the bounds (inclusive) taken modulo 2^w. */
+        static constexpr wrapped_interval from_unsigned( uwide_t lo, uwide_t hi, width_t w )
+        {
+            if ( hi - lo + 1 >= modulus( w ) )
+                return top( w );
+            return { value_t( lo ), value_t( hi ), w };
+        }
+
+        static constexpr wrapped_interval from_signed( wide_t lo, wide_t hi, width_t w )
+        {
+            if ( uwide_t( hi - lo ) + 1 >= modulus( w ) )
+                return top( w );
+            return { value_t( lo ), value_t( hi ), w };
+        }
+
+        static constexpr wrapped_interval from_bool( bool b ) { return constant( b, 1 ); }
+
+        static constexpr wrapped_interval from_tristate( __lava::tristate t )
+        {
+            if ( __lava::maybe( t ) )
+                return top( 1 );
+            return from_bool( static_cast< bool >( t ) );
+        }
+
+        constexpr bool is_bottom() const { return k == kind::bottom; }
+        constexpr bool is_top() const { return k == kind::top; }
+        constexpr bool is_constant() const { return k == kind::range && left == right; }
+
+        constexpr value_t smin_value() const { return value_t( 1 ) << ( bw - 1 ); }
+        constexpr value_t smax_value() const { return smin_value() - 1; }
+
+        constexpr wide_t to_signed( value_t v ) const
+        {
+            return v & smin_value() ? wide_t( v ) - wide_t( modulus( bw ) ) : wide_t( v );
+        }
+
+        /* Distance going up from `from` to `to`. */
+        constexpr value_t distance( value_t from, value_t to ) const { return ( to - from ) & mask( bw ); }
+
+        constexpr uwide_t cardinality() const
+        {
+            switch ( k ) {
+                case kind::bottom: return 0;
+                case kind::top:    return modulus( bw );
+                case kind::range:  return uwide_t( distance( left, right ) ) + 1;
+            }
+            __builtin_unreachable();
+        }
+
+        constexpr bool contains( value_t v ) const
+        {
+            switch ( k ) {
+                case kind::bottom: return false;
+                case kind::top:    return true;
+                case kind::range:  return distance( left, v & mask( bw ) ) <= distance( left, right );
+            }
+            __builtin_unreachable();
+        }
+
+        constexpr bool includes( const wrapped_interval &o ) const
+        {
+            if ( o.is_bottom() || is_top() )
+                return true;
+            if ( is_bottom() || o.is_top() )
+                return false;
+            return contains( o.left ) && contains( o.right )
+                && distance( left, o.left ) <= distance( left, o.right );
+        }
+
+        /* Pieces that do not cross the south pole (from 2^w - 1 to 0). */
+        constexpr pieces< value_t > unsigned_pieces() const
+        {
+            pieces< value_t > res;
+            if ( is_top() )
+                res.push( 0, mask( bw ) );
+            else if ( !is_bottom() ) {
+                if ( left <= right )
+                    res.push( left, right );
+                else {
+                    res.push( left, mask( bw ) );
+                    res.push( 0, right );
+                }
+            }
+            return res;
+        }
+
+        /* Pieces that do not cross the north pole (from 2^(w-1) - 1 to -2^(w-1)),
+         * as signed values. */
+        constexpr pieces< wide_t > signed_pieces() const
+        {
+            pieces< wide_t > res;
+            auto min = to_signed( smin_value() ), max = to_signed( smax_value() );
+            if ( is_top() )
+                res.push( min, max );
+            else if ( !is_bottom() ) {
+                auto l = to_signed( left ), r = to_signed( right );
+                if ( l <= r )
+                    res.push( l, r );
+                else {
+                    res.push( l, max );
+                    res.push( min, r );
+                }
+            }
+            return res;
+        }
+
+        constexpr value_t umin() const { return is_top() || left > right ? 0 : left; }
+        constexpr value_t umax() const { return is_top() || left > right ? mask( bw ) : right; }
+
+        constexpr wide_t smin() const
+        {
+            auto l = to_signed( left ), r = to_signed( right );
+            return is_top() || l > r ? to_signed( smin_value() ) : l;
+        }
+
+        constexpr wide_t smax() const
+        {
+            auto l = to_signed( left ), r = to_signed( right );
+            return is_top() || l > r ? to_signed( smax_value() ) : r;
+        }
+
+        explicit constexpr operator __lava::tristate() const noexcept
+        {
+            if ( is_constant() )
+                return __lava::tristate( left != 0 );
+            if ( contains( 0 ) )
+                return __lava::tristate( __lava::maybe );
+            return __lava::tristate( true );
+        }
+
+        friend constexpr wrapped_interval join( const wrapped_interval &a, const wrapped_interval &b )
+        {
+            if ( b.includes( a ) )
+                return b;
+            if ( a.includes( b ) )
+                return a;
+
+            auto w = a.bw;
+            if ( b.contains( a.left ) && b.contains( a.right ) && a.contains( b.left ) && a.contains( b.right ) )
+                return top( w );
+            if ( b.contains( a.right ) && a.contains( b.left ) )
+                return { a.left, b.right, w };
+            if ( a.contains( b.right ) && b.contains( a.left ) )
+                return { b.left, a.right, w };
+
+            // disjoint, fill the smaller gap
+            if ( a.distance( a.right, b.left ) <= a.distance( b.right, a.left ) )
+                return { a.left, b.right, w };
+            return { b.left, a.right, w };
+        }
+
+        /* The intersection of wrapped intervals may consist of two intervals,
+         * then the smaller operand is its over-approximation. */
+        friend constexpr wrapped_interval meet( const wrapped_interval &a, const wrapped_interval &b )
+        {
+            if ( b.includes( a ) )
+                return a;
+            if ( a.includes( b ) )
+                return b;
+
+            auto w = a.bw;
+            bool al = b.contains( a.left ), bl = a.contains( b.left );
+            if ( !al && !bl )
+                return bottom( w );
+            if ( al && bl )
+                return a.cardinality() <= b.cardinality() ? a : b;
+            if ( al )
+                return { a.left, b.right, w };
+            return { b.left, a.right, w };
+        }
+
+        /* Widening stretches the unstable ends of the join by the size of the
+         * previous iterate, so the cardinality at least doubles in each step
+         * and reaches top in at most `bw` steps. */
+        friend constexpr wrapped_interval widen( const wrapped_interval &a, const wrapped_interval &b )
+        {
+            if ( a.includes( b ) )
+                return a;
+
+            auto w = a.bw;
+            auto j = join( a, b );
+            if ( a.is_bottom() || j.is_top() )
+                return j;
+
+            auto grow = a.cardinality();
+            bool left = j.left != a.left, right = j.right != a.right;
+            if ( j.cardinality() + grow * ( left + right ) >= modulus( w ) )
+                return top( w );
+
+            return { value_t( j.left - ( left ? grow : 0 ) ), value_t( j.right + ( right ? grow : 0 ) ), w };
+        }
+
+        friend constexpr wrapped_interval smaller( const wrapped_interval &a, const wrapped_interval &b )
+        {
+            return a.cardinality() <= b.cardinality() ? a : b;
+        }
+
+        constexpr bool operator==( const wrapped_interval &o ) const
+        {
+            return k == o.k && bw == o.bw && ( k != kind::range || ( left == o.left && right == o.right ) );
+        }
+    };
+
+} // namespace sup
@@ -19,11 +19,14 @@
 #include <lava/support/tristate.hpp>
 #include <lava/support/base.hpp>
 #include <lava/support/mmaped_pointer.hpp>
+#include <lava/support/independence.hpp>
 
 #include <lamp/support/tracing.hpp>
 
 #include <cstdio>
 #include <cstring>
+#include <optional>
+#include <unistd.h>
 #include <type_traits>
 #include <z3++.h>
 
@@ -32,10 +35,13 @@ using namespace std::string_literals;
 namespace __lava
 {
     inline void do_trace_model();
+    inline void do_trace_stats();
+    inline void do_report_unknown();
 
     struct term_config_t
     {
         bool trace_model = false;
+        bool trace_stats = false;
 
         ~term_config_t() {
             if (this->trace_model) {
@@ -43,17 +49,34 @@ namespace __lava
                 // do not trace model multiple times
                 this->trace_model = false;
             }
+
+            if (this->trace_stats) {
+                do_trace_stats();
+                this->trace_stats = false;
+            }
+
+            do_report_unknown();
         }
     };
 
+    /* Counters shared by all processes of the exploration. */
+    struct term_stats_t
+    {
+        pid_t root;
+        uint64_t forks_avoided;
+        uint64_t unknown; // queries that timed out or hit the memory limit
+    };
+
     struct term_state_t
     {
         term_state_t()
-            : solver( ctx )
+            : solver( ctx ), path( ctx ), limits( ctx )
         {}
 
         z3::context ctx;
         z3::solver solver;
+        path_condition path;
+        z3::params limits; // of each solver query
     };
 
     static unsigned variable_counter()
@@ -63,7 +86,10 @@ namespace __lava
     }
 
     std::unique_ptr< term_state_t > __term_state;
+    // declared before config, whose destructor reports the stats
+    unique_mapped_ptr< term_stats_t > __term_stats;
     unique_mapped_ptr< term_config_t > __term_cfg;
+    unique_mapped_ptr< query_cache > __term_cache;
 
     template< template< typename > typename storage >
     struct term : storage< z3::expr >
@@ -129,17 +155,56 @@ namespace __lava
 
         static void assume( tr t, bool expected )
         {
-            auto &solver = __term_state->solver;
             const auto& e = t.get();
             auto b = e.is_bool() ? e : tobool( e );
-            solver.add( expected ? b : !b );
+            auto constraint = expected ? b : !b;
+
+            auto result = check( constraint );
+            constrain( constraint );
 
-            if ( solver.check() == z3::unsat ) {
+            if ( result == z3::unsat ) {
                 __lart_cancel();
             }
         }
 
-        static tristate to_tristate( tr ) { return maybe; }
+        /* Extends the path condition by a constraint known to be feasible. */
+        static void constrain( const z3::expr &constraint )
+        {
+            auto &state = *__term_state;
+            // the whole path condition is kept only for model tracing,
+            // feasibility is decided on the independent slice
+            state.solver.add( constraint );
+            state.path.add( constraint );
+        }
+
+        /* Unknown results are treated as feasible, the exploration continues
+         * and its result is reported as inconclusive. */
+        static z3::check_result check( const z3::expr &query )
+        {
+            auto result = __term_state->path.check( query );
+            if ( result == z3::unknown )
+                ++__term_stats->unknown;
+            return result;
+        }
+
+        /* Decides the condition when only one of its polarities is feasible
+         * under the path condition, so that the branch does not fork. */
+        static tristate to_tristate( tr t )
+        {
+            const auto& e = t.get();
+            auto b = e.is_bool() ? e : tobool( e );
+
+            auto definite = [] ( bool value ) {
+                ++__term_stats->forks_avoided;
+                return tristate( value );
+            };
+
+            if ( check( b ) == z3::unsat )
+                return definite( false );
+            if ( check( !b ) == z3::unsat )
+                return definite( true );
+            return maybe;
+        }
 
         /* arithmetic operations */
         static term op_add ( tr a, tr b ) { return a.get() + b.get(); }
@@ -220,18 +285,41 @@ namespace __lava
     inline void do_trace_model()
     {
         auto &solver = __term_state->solver;
-        auto model = solver.get_model();
+        // assumptions are checked only on slices, model needs the whole path
+        std::optional< z3::model > model;
+        try {
+            if ( solver.check() == z3::sat )
+                model = solver.get_model();
+        } catch ( z3::exception & ) {}
+
+        if ( !model )
+            return;
 
         using file_stream = __lart::rt::file_stream;
         auto stream = file_stream( stderr );
 
-        for (int i = 0; unsigned(i) < model.size(); i++) {
-            const auto &v = model[i];
-            auto interp = model.get_const_interp(v);
+        for (int i = 0; unsigned(i) < model->size(); i++) {
+            const auto &v = (*model)[i];
+            auto interp = model->get_const_interp(v);
             stream << "[term model] " << v.name() << " = " << Z3_ast_to_string( __term_state->ctx, interp ) << '\n';
         }
     }
 
+    inline void do_trace_stats()
+    {
+        if ( __term_stats->root != getpid() )
+            return;
+        fprintf( stderr, "[term stats] forks avoided: %lu\n", __term_stats->forks_avoided );
+    }
+
+    inline void do_report_unknown()
+    {
+        if ( __term_stats->root != getpid() || __term_stats->unknown == 0 )
+            return;
+        fprintf( stderr, "[term status] inconclusive, %lu queries timed out or ran out of memory\n",
+                 __term_stats->unknown );
+    }
+
     inline bool option( std::string_view option, std::string_view msg )
     {
         auto is_set = [] ( auto opt ) { return opt && strcmp( opt, "ON" ) == 0; };
@@ -242,12 +330,41 @@ namespace __lava
         return false;
     }
 
-    [[gnu::constructor]] void term_setup()
+    /* Solver limit given in the environment variable, it bounds each query
+     * of the path condition. Unlike the global `memory_max_size`, which
+     * breaks the whole context once exceeded, a limit of the solver makes
+     * only the query unknown. */
+    inline void limit( z3::params &params, const char *var, const char *param, std::string_view msg )
+    {
+        if ( auto value = std::getenv( var ) ) {
+            fprintf( stderr, "[term config] %s = %s\n", msg.data(), value );
+            params.set( param, unsigned( std::strtoul( value, nullptr, 10 ) ) );
+        }
+    }
+
+    /* runs before setup of extensions that configure the term state */
+    [[gnu::constructor( 101 )]] void term_setup()
     {
         __term_state = std::make_unique< term_state_t >();
+
+        auto &limits = __term_state->limits;
+        limit( limits, "TERM_TIMEOUT", "timeout", "query timeout (ms)" );
+        limit( limits, "TERM_MEMORY_LIMIT", "max_memory", "solver memory limit (MB)" );
+        __term_state->solver.set( limits );
+        __term_state->path.limits( limits );
         __term_cfg = make_mmap_unique< term_config_t >();
 
         __term_cfg->trace_model = option("TERM_TRACE_MODEL", "term trace model");
+        __term_cfg->trace_stats = option("TERM_TRACE_STATS", "term trace stats");
+
+        __term_stats = make_mmap_shared< term_stats_t >();
+        __term_stats->root = getpid();
+
+        auto cache_file = std::getenv( "TERM_QUERY_CACHE" );
+        if ( cache_file )
+            fprintf( stderr, "[term config] query cache = %s\n", cache_file );
+        __term_cache = map_query_cache( cache_file );
+        __term_state->path.cache( __term_cache.get() );
     }
 
 } // namespace __lava
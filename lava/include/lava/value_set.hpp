@@ -0,0 +1,408 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/base.hpp>
+#include <lava/support/scalar.hpp>
+#include <lava/support/reference.hpp>
+#include <lava/support/value_set.hpp>
+
+#include <sstream>
+#include <string>
+
+namespace __lava
+{
+    using value_set_storage = sup::value_set;
+
+    /* Value-set domain keeps small sets of possible values exactly, e.g.,
+     * results of a nondeterministic choice among a few constants, and falls
+     * back to intervals for larger sets. It ignores bitwidth like the
+     * interval domain. */
+    template< template< typename > typename storage >
+    struct value_set : storage< value_set_storage >
+                     , domain_mixin< value_set< storage > >
+    {
+        using base = storage< value_set_storage >;
+        using mixin = domain_mixin< value_set >;
+
+        using bw = typename mixin::bw;
+        using base::base;
+
+        using vs = value_set;
+        using vr = const value_set &;
+
+        using ref = domain_ref< value_set >;
+
+        using value_t = value_set_storage::value_t;
+        using bound_t = value_set_storage::bound_t;
+        using interval_t = value_set_storage::interval_t;
+
+        value_set( const value_set_storage &v ) : base( v ) {}
+
+        static vs top() { return value_set_storage::top(); }
+        static vs constant( value_t v ) { return value_set_storage::constant( v ); }
+        static vs hull( const interval_t &i ) { return value_set_storage::from_interval( i ); }
+
+        template< typename type > static auto lift( const type &v )
+            -> std::enable_if_t< std::is_integral_v< type >, vs >
+        {
+            return constant( value_t( v ) );
+        }
+
+        template< typename type > static auto lift( const type & )
+            -> std::enable_if_t< !std::is_integral_v< type >, vs >
+        {
+            return mixin::fail( "non-integral lift" );
+        }
+
+        template< typename type > static vs any()
+        {
+            if constexpr ( std::is_same_v< type, bool > )
+                return value_set_storage::from_tristate( maybe );
+            else if constexpr ( std::is_integral_v< type > )
+                return top();
+            else
+                return mixin::fail( "non-integral any" );
+        }
+
+        template< typename type > static vs any( const variadic_list &args )
+        {
+            auto res = value_set_storage::bottom();
+            for ( auto v : args.range< type >() )
+                res = join( res, value_set_storage::constant( value_t( v ) ) );
+            return res;
+        }
+
+        template< typename type > static vs any( type from, type to )
+        {
+            return hull( { from, to } );
+        }
+
+        void intersect( const value_set_storage &other )
+        {
+            this->get() = meet( this->get(), other );
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
+
+        void intersect( const interval_t &other )
+        {
+            this->get() = this->get().intersect( other );
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
+
+        void exclude( value_t v )
+        {
+            this->get() = this->get().exclude( v );
+            if ( this->get().is_bottom() )
+                __lart_cancel();
+        }
+
+        static void assume( value_set &v, bool constraint )
+        {
+            if ( constraint )
+                v.exclude( 0 );
+            else
+                v.intersect( value_set_storage::constant( 0 ) );
+        }
+
+        static tristate to_tristate( vr v )
+        {
+            return static_cast< tristate >( v.get() );
+        }
+
+        /* lattice operations */
+        static vs op_join( vr a, vr b ) { return join( a.get(), b.get() ); }
+        static vs op_meet( vr a, vr b ) { return meet( a.get(), b.get() ); }
+
+        /* Exact sets grow at most to the capacity, then unstable bounds of
+         * the hull jump to infinity. */
+        static vs op_widen( vr a, vr b )
+        {
+            auto j = join( a.get(), b.get() );
+            if ( a->is_bottom() || j.is_exact() || a->includes( b.get() ) )
+                return j;
+
+            auto low = b->hull.low < a->hull.low ? bound_t::minus_infinity() : a->hull.low;
+            auto high = a->hull.high < b->hull.high ? bound_t::plus_infinity() : a->hull.high;
+            return value_set_storage::wrap( { low, high } );
+        }
+
+        static bool subsumes( vr a, vr b ) { return a->includes( b.get() ); }
+
+        /* Exact operands are combined elementwise, if the hull of the result
+         * is finite the elementwise operation does not overflow. */
+        template< typename op, typename fallback >
+        static vs arith( vr a, vr b, op f, fallback g )
+        {
+            if ( a->is_bottom() || b->is_bottom() )
+                return value_set_storage::bottom();
+            auto h = g( a->hull, b->hull );
+            if ( a->wide || b->wide || h.is_infinite() )
+                return hull( h );
+            return value_set_storage::pairwise( a.get(), b.get(), f );
+        }
+
+        static bool finite( vr a ) { return !a->wide && a->hull.is_finite(); }
+
+        /* arithmetic operations */
+        static vs op_add( vr a, vr b )
+        {
+            return arith( a, b, [] ( value_t x, value_t y ) { return x + y; },
+                                [] ( const auto &x, const auto &y ) { return x + y; } );
+        }
+
+        static vs op_sub( vr a, vr b )
+        {
+            return arith( a, b, [] ( value_t x, value_t y ) { return x - y; },
+                                [] ( const auto &x, const auto &y ) { return x - y; } );
+        }
+
+        static vs op_mul( vr a, vr b )
+        {
+            return arith( a, b, [] ( value_t x, value_t y ) { return x * y; },
+                                [] ( const auto &x, const auto &y ) { return x * y; } );
+        }
+
+        /* Zero divisors are skipped, a division only by zero cancels. */
+        template< typename op, typename fallback >
+        static vs division( vr a, vr b, op f, fallback g )
+        {
+            if ( a->is_bottom() || b->is_bottom() )
+                return value_set_storage::bottom();
+            if ( finite( a ) && finite( b ) ) {
+                auto divisors = b->exclude( 0 );
+                if ( divisors.is_bottom() )
+                    __lart_cancel();
+                return value_set_storage::pairwise( a.get(), divisors, f );
+            }
+            if ( b->hull.includes( bound_t( 0 ) ) )
+                return top();
+            return hull( g( a->hull, b->hull ) );
+        }
+
+        static vs op_sdiv( vr a, vr b )
+        {
+            return division( a, b, [] ( value_t x, value_t y ) { return x / y; },
+                                   [] ( const auto &x, const auto &y ) { return x / y; } );
+        }
+
+        /* The remainder takes the sign of the dividend and is smaller than
+         * the largest divisor in magnitude. */
+        static interval_t remainder( const interval_t &a, const interval_t &b )
+        {
+            auto m = std::max( -b.low, b.high ) - 1;
+            if ( bound_t( 0 ) <= a.low )
+                return { bound_t( 0 ), std::min( a.high, m ) };
+            if ( a.high <= bound_t( 0 ) )
+                return { std::max( a.low, -m ), bound_t( 0 ) };
+            return { -m, m };
+        }
+
+        static vs op_srem( vr a, vr b )
+        {
+            return division( a, b, [] ( value_t x, value_t y ) { return x % y; }, remainder );
+        }
+
+        static vs op_udiv( vr a, vr b ) { return op_sdiv( a, b ); } // FIXME
+        static vs op_urem( vr a, vr b ) { return op_srem( a, b ); } // FIXME
+
+        /* bitwise operations */
+        static bool shift_amount( vr b ) { return !b->is_bottom() && b->min() >= 0 && b->max() < 63; }
+
+        static vs op_shl( vr a, vr b )
+        {
+            if ( !finite( a ) || !finite( b ) || !shift_amount( b ) )
+                return top();
+            auto limit = value_t( 1 ) << ( 62 - b->max() );
+            if ( a->min() < -limit || a->max() >= limit )
+                return top();
+            return value_set_storage::pairwise( a.get(), b.get(), [] ( value_t x, value_t y ) {
+                return value_t( uint64_t( x ) << y );
+            } );
+        }
+
+        static vs op_ashr( vr a, vr b )
+        {
+            if ( !shift_amount( b ) )
+                return top();
+            if ( finite( a ) && finite( b ) )
+                return value_set_storage::pairwise( a.get(), b.get(), [] ( value_t x, value_t y ) { return x >> y; } );
+            return hull( a->hull >> b->hull );
+        }
+
+        static vs op_lshr( vr a, vr b ) { return op_ashr( a, b ); } // FIXME
+
+        template< typename op >
+        static vs bitwise( vr a, vr b, op f )
+        {
+            if ( finite( a ) && finite( b ) )
+                return value_set_storage::pairwise( a.get(), b.get(), f );
+            return top();
+        }
+
+        static vs op_and( vr a, vr b ) { return bitwise( a, b, [] ( value_t x, value_t y ) { return x & y; } ); }
+        static vs op_or ( vr a, vr b ) { return bitwise( a, b, [] ( value_t x, value_t y ) { return x | y; } ); }
+        static vs op_xor( vr a, vr b ) { return bitwise( a, b, [] ( value_t x, value_t y ) { return x ^ y; } ); }
+
+        /* comparison operations */
+        template< typename op, typename fallback >
+        static vs compare( vr a, vr b, op f, fallback g )
+        {
+            if ( a->is_exact() && b->is_exact() )
+                return value_set_storage::pairwise( a.get(), b.get(), [f] ( value_t x, value_t y ) {
+                    return value_t( f( x, y ) );
+                } );
+            return value_set_storage::from_tristate( g( a->hull, b->hull ) );
+        }
+
+        static vs op_eq( vr a, vr b )
+        {
+            return compare( a, b, [] ( value_t x, value_t y ) { return x == y; },
+                                  [] ( const auto &x, const auto &y ) { return x == y; } );
+        }
+
+        static vs op_ne( vr a, vr b )
+        {
+            return compare( a, b, [] ( value_t x, value_t y ) { return x != y; },
+                                  [] ( const auto &x, const auto &y ) { return x != y; } );
+        }
+
+        static vs op_slt( vr a, vr b )
+        {
+            return compare( a, b, [] ( value_t x, value_t y ) { return x < y; },
+                                  [] ( const auto &x, const auto &y ) { return x < y; } );
+        }
+
+        static vs op_sle( vr a, vr b )
+        {
+            return compare( a, b, [] ( value_t x, value_t y ) { return x <= y; },
+                                  [] ( const auto &x, const auto &y ) { return x <= y; } );
+        }
+
+        static vs op_sgt( vr a, vr b ) { return op_slt( b, a ); }
+        static vs op_sge( vr a, vr b ) { return op_sle( b, a ); }
+
+        static vs op_ult( vr a, vr b ) { return op_slt( a, b ); } // FIXME
+        static vs op_ule( vr a, vr b ) { return op_sle( a, b ); } // FIXME
+        static vs op_ugt( vr a, vr b ) { return op_sgt( a, b ); } // FIXME
+        static vs op_uge( vr a, vr b ) { return op_sge( a, b ); } // FIXME
+
+        // unbounded value sets ignore bitwidth
+        static vs op_sext ( vr a, bw ) { return a.get(); }
+        static vs op_trunc( vr a, bw ) { return a.get(); }
+        static vs op_zext ( vr a, bw ) { return a.get(); }
+        static vs op_zfit ( vr a, bw ) { return a.get(); }
+
+        /* backward operations */
+        static void bop_add( vr r, ref a, ref b )
+        {
+            a.intersect( op_sub( r, b ).get() );
+            b.intersect( op_sub( r, a ).get() );
+        }
+
+        static void bop_sub( vr r, ref a, ref b )
+        {
+            a.intersect( op_add( r, b ).get() );
+            b.intersect( op_sub( a, r ).get() );
+        }
+
+        static void bop_mul( vr, vr, vr ) {}
+        static void bop_sdiv( vr, vr, vr ) {}
+        static void bop_udiv( vr, vr, vr ) {}
+        static void bop_srem( vr, vr, vr ) {}
+        static void bop_urem( vr, vr, vr ) {}
+
+        static void bop_shl ( vr, vr, vr ) {}
+        static void bop_ashr( vr, vr, vr ) {}
+        static void bop_lshr( vr, vr, vr ) {}
+        static void bop_and ( vr, vr, vr ) {}
+        static void bop_or  ( vr, vr, vr ) {}
+        static void bop_xor ( vr, vr, vr ) {}
+
+        static void bop_trunc( vr r, ref a ) { a.intersect( r.get() ); }
+        static void bop_zext ( vr r, ref a ) { a.intersect( r.get() ); }
+        static void bop_sext ( vr r, ref a ) { a.intersect( r.get() ); }
+        static void bop_zfit ( vr r, ref a ) { a.intersect( r.get() ); }
+
+        static void beq( vr r, ref a, ref b, bool negated = false )
+        {
+            auto t = to_tristate( r );
+            if ( maybe( t ) )
+                return;
+
+            if ( static_cast< bool >( t ) != negated ) {
+                a.intersect( b.get() );
+                b.intersect( a.get() );
+            } else {
+                if ( b->is_constant() )
+                    a.exclude( b->values[ 0 ] );
+                if ( a->is_constant() )
+                    b.exclude( a->values[ 0 ] );
+            }
+        }
+
+        /* a > b (or a <= b if negated) bounds each operand by the extreme of the other */
+        static void bgt( vr r, ref a, ref b, bool negated = false )
+        {
+            auto t = to_tristate( r );
+            if ( maybe( t ) )
+                return;
+
+            auto inf = bound_t::plus_infinity();
+            if ( static_cast< bool >( t ) != negated ) {
+                a.intersect( interval_t( b->hull.low + 1, inf ) );
+                b.intersect( interval_t( -inf, a->hull.high - 1 ) );
+            } else {
+                a.intersect( interval_t( -inf, b->hull.high ) );
+                b.intersect( interval_t( a->hull.low, inf ) );
+            }
+        }
+
+        static void bop_eq( vr r, vr a, vr b ) { beq( r, a, b ); }
+        static void bop_ne( vr r, vr a, vr b ) { beq( r, a, b, true /* negated */ ); }
+
+        static void bop_sgt( vr r, vr a, vr b ) { bgt( r, a, b ); }
+        static void bop_slt( vr r, vr a, vr b ) { bgt( r, b, a ); }
+        static void bop_sge( vr r, vr a, vr b ) { bgt( r, b, a, true /* negated */ ); }
+        static void bop_sle( vr r, vr a, vr b ) { bgt( r, a, b, true /* negated */ ); }
+
+        static void bop_ugt( vr r, vr a, vr b ) { bop_sgt( r, a, b ); }
+        static void bop_uge( vr r, vr a, vr b ) { bop_sge( r, a, b ); }
+        static void bop_ult( vr r, vr a, vr b ) { bop_slt( r, a, b ); }
+        static void bop_ule( vr r, vr a, vr b ) { bop_sle( r, a, b ); }
+
+        static std::string trace( vr v )
+        {
+            std::stringstream ss;
+            if ( v->wide ) {
+                ss << '[' << v->hull.low << ", " << v->hull.high << ']';
+                return ss.str();
+            }
+
+            ss << '{';
+            for ( unsigned i = 0; i < v->count; ++i )
+                ss << ( i ? ", " : "" ) << v->values[ i ];
+            ss << '}';
+            return ss.str();
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, vr v ) { return os << trace( v ); }
+    };
+} // namespace __lava
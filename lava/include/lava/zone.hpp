@@ -0,0 +1,391 @@
+/*
+ * (c) 2021 Henrich Lauko <xlauko@mail.muni.cz>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <lava/support/base.hpp>
+#include <lava/support/dbm.hpp>
+#include <lava/support/interval.hpp>
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+namespace __lava
+{
+    /* Per-path environment of the zone domain: a closed difference-bound
+     * matrix over a fixed number of variable slots. Slots are recycled
+     * round-robin, a value whose slot was reused is restored from the bounds
+     * it cached when it was last seen. */
+    struct zone_state_t
+    {
+        static constexpr unsigned capacity = 64;
+
+        sup::dbm< capacity > dbm;
+        std::array< uint32_t, capacity > generation = {};
+        unsigned next = 1;
+
+        unsigned allocate( unsigned avoid_a = 0, unsigned avoid_b = 0 )
+        {
+            auto advance = [&] { next = next % ( capacity - 1 ) + 1; };
+            while ( next == avoid_a || next == avoid_b )
+                advance();
+
+            auto slot = next;
+            advance();
+            dbm.forget( slot );
+            ++generation[ slot ];
+            return slot;
+        }
+    };
+
+    inline zone_state_t __zone_state;
+
+    struct zone_var
+    {
+        using value_t = int64_t;
+
+        static constexpr value_t inf = decltype( zone_state_t::dbm )::inf;
+
+        uint8_t slot = 0;
+        uint32_t generation = 0;
+        value_t lo = -inf, hi = inf; /* bounds when the slot was last seen */
+    };
+
+    struct zone_storage
+    {
+        /* comparison `lhs rel rhs`, whose result the value is */
+        enum class relation : uint8_t { none, eq, ne, lt, le };
+
+        mutable zone_var var;
+        relation rel = relation::none;
+        mutable zone_var lhs = {}, rhs = {};
+    };
+
+    /* Zone domain relates abstract values by constraints x - y <= c, so that
+     * e.g. `i < len` survives an update `i = i + 1`. Each value is a variable
+     * of the per-path DBM and, if it is a result of a comparison, remembers
+     * the compared variables to decide and assume the comparison. Like the
+     * interval domain, values are unbounded integers. */
+    template< template< typename > typename storage >
+    struct zone : storage< zone_storage >
+                , domain_mixin< zone< storage > >
+    {
+        using base = storage< zone_storage >;
+        using mixin = domain_mixin< zone >;
+
+        using bw = typename mixin::bw;
+        using base::base;
+
+        using zv = zone;
+        using zr = const zone &;
+
+        using value_t = zone_var::value_t;
+        using relation = zone_storage::relation;
+
+        using bound = sup::bound< value_t >;
+        using interval = sup::interval< bound >;
+
+        static constexpr value_t inf = zone_var::inf;
+
+        zone( const zone_storage &v ) : base( v ) {}
+
+        static zone_state_t &state() { return __zone_state; }
+        static auto &dbm() { return state().dbm; }
+
+        static value_t clamp( value_t v ) { return std::clamp( v, -inf, inf ); }
+
+        static zone_var fresh( value_t lo, value_t hi, unsigned avoid_a = 0, unsigned avoid_b = 0 )
+        {
+            auto slot = state().allocate( avoid_a, avoid_b );
+            dbm().constrain( slot, 0, clamp( lo ), clamp( hi ) );
+            return { uint8_t( slot ), state().generation[ slot ], clamp( lo ), clamp( hi ) };
+        }
+
+        /* Returns a live slot of the variable and refreshes its cached bounds. */
+        static unsigned slot( zone_var &v, unsigned avoid = 0 )
+        {
+            if ( v.slot == 0 || state().generation[ v.slot ] != v.generation )
+                v = fresh( v.lo, v.hi, avoid );
+            v.lo = dbm().lower( v.slot );
+            v.hi = dbm().upper( v.slot );
+            return v.slot;
+        }
+
+        static std::pair< unsigned, unsigned > slots( zone_var &a, zone_var &b )
+        {
+            auto x = slot( a );
+            return { x, slot( b, x ) };
+        }
+
+        static interval bounds( const zone_var &v )
+        {
+            return { v.lo <= -inf ? bound::minus_infinity() : bound( v.lo ),
+                     v.hi >= inf ? bound::plus_infinity() : bound( v.hi ) };
+        }
+
+        static value_t lower( const bound &b ) { return b == bound::minus_infinity() ? -inf : clamp( value_t( b ) ); }
+        static value_t upper( const bound &b ) { return b == bound::plus_infinity() ? inf : clamp( value_t( b ) ); }
+
+        static zv value( value_t lo, value_t hi ) { return zone_storage{ fresh( lo, hi ) }; }
+
+        static zv comparison( relation rel, zr a, zr b )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            return zone_storage{ fresh( 0, 1, x, y ), rel, a->var, b->var };
+        }
+
+        template< typename type > static zv lift( const type &v )
+        {
+            if constexpr ( std::is_integral_v< type > )
+                return value( value_t( v ), value_t( v ) );
+            else
+                return mixin::fail( "non-integral lift" );
+        }
+
+        template< typename type > static zv any() { return value( -inf, inf ); }
+
+        template< typename type > static zv any( const variadic_list &args )
+        {
+            value_t lo = inf, hi = -inf;
+            for ( auto v : args.range< type >() ) {
+                lo = std::min( lo, value_t( v ) );
+                hi = std::max( hi, value_t( v ) );
+            }
+            return value( lo, hi );
+        }
+
+        template< typename type > static zv any( type from, type to )
+        {
+            return value( value_t( from ), value_t( to ) );
+        }
+
+        static tristate decide( relation rel, zone_var &a, zone_var &b )
+        {
+            auto [x, y] = slots( a, b );
+            auto &d = dbm();
+            bool lt = d.entails( x, y, -1 ), le = d.entails( x, y, 0 );
+            bool gt = d.entails( y, x, -1 ), ge = d.entails( y, x, 0 );
+
+            auto result = [] ( bool yes, bool no ) {
+                return yes ? tristate( true ) : no ? tristate( false ) : tristate( maybe );
+            };
+
+            switch ( rel ) {
+                case relation::lt: return result( lt, ge );
+                case relation::le: return result( le, gt );
+                case relation::eq: return result( le && ge, lt || gt );
+                case relation::ne: return result( lt || gt, le && ge );
+                case relation::none: break;
+            }
+            __builtin_unreachable();
+        }
+
+        static tristate to_tristate( zr v )
+        {
+            if ( v->rel != relation::none )
+                return decide( v->rel, v->lhs, v->rhs );
+
+            slot( v->var );
+            if ( v->var.lo > 0 || v->var.hi < 0 )
+                return tristate( true );
+            if ( v->var.lo == 0 && v->var.hi == 0 )
+                return tristate( false );
+            return tristate( maybe );
+        }
+
+        static void assume( zone &v, bool expected )
+        {
+            auto &d = dbm();
+            bool consistent = true;
+
+            auto x = slot( v->var );
+            if ( !expected )
+                consistent = d.constrain( x, 0, 0, 0 );
+            else if ( v->var.lo >= 0 )
+                consistent = d.constrain( 0, x, -1 );
+            else if ( v->var.hi <= 0 )
+                consistent = d.constrain( x, 0, -1 );
+
+            if ( consistent && v->rel != relation::none ) {
+                auto [l, r] = slots( v->lhs, v->rhs );
+                bool eq = d.entails( l, r, 0 ) && d.entails( r, l, 0 );
+                switch ( v->rel ) {
+                    case relation::lt:
+                        consistent = expected ? d.constrain( l, r, -1 ) : d.constrain( r, l, 0 );
+                        break;
+                    case relation::le:
+                        consistent = expected ? d.constrain( l, r, 0 ) : d.constrain( r, l, -1 );
+                        break;
+                    case relation::eq:
+                        consistent = expected ? d.constrain( l, r, 0, 0 ) : !eq;
+                        break;
+                    case relation::ne:
+                        consistent = expected ? !eq : d.constrain( l, r, 0, 0 );
+                        break;
+                    case relation::none:
+                        break;
+                }
+            }
+
+            if ( !consistent )
+                __lart_cancel();
+        }
+
+        /* lattice operations */
+        static zv op_join( zr a, zr b )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            return zone_storage{ fresh( std::min( a->var.lo, b->var.lo ), std::max( a->var.hi, b->var.hi ), x, y ) };
+        }
+
+        static zv op_meet( zr a, zr b )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            auto lo = std::max( a->var.lo, b->var.lo ), hi = std::min( a->var.hi, b->var.hi );
+            if ( lo > hi )
+                __lart_cancel();
+            return zone_storage{ fresh( lo, hi, x, y ) };
+        }
+
+        static zv op_widen( zr a, zr b )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            auto lo = b->var.lo < a->var.lo ? -inf : a->var.lo;
+            auto hi = b->var.hi > a->var.hi ? inf : a->var.hi;
+            return zone_storage{ fresh( lo, hi, x, y ) };
+        }
+
+        static bool subsumes( zr a, zr b )
+        {
+            slots( a->var, b->var );
+            return a->var.lo <= b->var.lo && b->var.hi <= a->var.hi;
+        }
+
+        /* Non-relational operations compute the bounds by interval arithmetic. */
+        template< typename op_t >
+        static zv bounded( zr a, zr b, op_t op )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            auto i = op( bounds( a->var ), bounds( b->var ) );
+            return zone_storage{ fresh( lower( i.low ), upper( i.high ), x, y ) };
+        }
+
+        /* r = a + b implies r - a in [b] and r - b in [a] */
+        static zv op_add( zr a, zr b )
+        {
+            auto r = bounded( a, b, [] ( auto x, auto y ) { return x + y; } );
+            auto &d = dbm();
+            d.constrain( r->var.slot, a->var.slot, b->var.lo, b->var.hi );
+            d.constrain( r->var.slot, b->var.slot, a->var.lo, a->var.hi );
+            slot( r->var );
+            return r;
+        }
+
+        /* r = a - b implies r - a in -[b] */
+        static zv op_sub( zr a, zr b )
+        {
+            auto r = bounded( a, b, [] ( auto x, auto y ) { return x - y; } );
+            dbm().constrain( r->var.slot, a->var.slot, -b->var.hi, -b->var.lo );
+            slot( r->var );
+            return r;
+        }
+
+        static zv op_mul ( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l * r; } ); }
+        static zv op_sdiv( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l / r; } ); }
+        static zv op_udiv( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l / r; } ); } // FIXME
+        static zv op_srem( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l % r; } ); }
+        static zv op_urem( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l % r; } ); } // FIXME
+
+        static zv op_shl ( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l << r; } ); }
+        static zv op_ashr( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l >> r; } ); } // FIXME
+        static zv op_lshr( zr a, zr b ) { return bounded( a, b, [] ( auto l, auto r ) { return l >> r; } ); }
+
+        /* For non-negative operands: a & b <= min(a, b), a | b <= a + b, a ^ b <= a + b. */
+        template< typename op_t >
+        static zv bitwise( zr a, zr b, op_t high )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            if ( a->var.lo < 0 || b->var.lo < 0 )
+                return zone_storage{ fresh( -inf, inf, x, y ) };
+            return zone_storage{ fresh( 0, high( a->var.hi, b->var.hi ), x, y ) };
+        }
+
+        static zv op_and( zr a, zr b ) { return bitwise( a, b, [] ( auto l, auto r ) { return std::min( l, r ); } ); }
+        static zv op_or ( zr a, zr b ) { return bitwise( a, b, [] ( auto l, auto r ) { return clamp( l + r ); } ); }
+        static zv op_xor( zr a, zr b ) { return bitwise( a, b, [] ( auto l, auto r ) { return clamp( l + r ); } ); }
+
+        static zv op_eq ( zr a, zr b ) { return comparison( relation::eq, a, b ); }
+        static zv op_ne ( zr a, zr b ) { return comparison( relation::ne, a, b ); }
+        static zv op_slt( zr a, zr b ) { return comparison( relation::lt, a, b ); }
+        static zv op_sle( zr a, zr b ) { return comparison( relation::le, a, b ); }
+        static zv op_sgt( zr a, zr b ) { return comparison( relation::lt, b, a ); }
+        static zv op_sge( zr a, zr b ) { return comparison( relation::le, b, a ); }
+
+        /* unsigned comparisons agree with signed ones on non-negative values */
+        static zv unsigned_comparison( relation rel, zr a, zr b )
+        {
+            auto [x, y] = slots( a->var, b->var );
+            if ( a->var.lo < 0 || b->var.lo < 0 )
+                return zone_storage{ fresh( 0, 1, x, y ) };
+            return comparison( rel, a, b );
+        }
+
+        static zv op_ult( zr a, zr b ) { return unsigned_comparison( relation::lt, a, b ); }
+        static zv op_ule( zr a, zr b ) { return unsigned_comparison( relation::le, a, b ); }
+        static zv op_ugt( zr a, zr b ) { return unsigned_comparison( relation::lt, b, a ); }
+        static zv op_uge( zr a, zr b ) { return unsigned_comparison( relation::le, b, a ); }
+
+        // unbounded zone domain ignores bitwidth
+        static zv copy( zr a ) { return zone_storage{ a->var, a->rel, a->lhs, a->rhs }; }
+
+        static zv op_sext ( zr a, bw ) { return copy( a ); }
+        static zv op_trunc( zr a, bw ) { return copy( a ); }
+        static zv op_zext ( zr a, bw ) { return copy( a ); }
+        static zv op_zfit ( zr a, bw ) { return copy( a ); }
+
+        static std::string trace( zr v )
+        {
+            auto print = [] ( zone_var &var ) {
+                slot( var );
+                auto bound = [] ( value_t b ) {
+                    return b <= -inf ? std::string( "-∞" ) : b >= inf ? std::string( "∞" ) : std::to_string( b );
+                };
+                return "v" + std::to_string( var.slot ) + ": [" + bound( var.lo ) + ", " + bound( var.hi ) + "]";
+            };
+
+            auto res = print( v->var );
+            auto rel = [&] () -> std::string {
+                switch ( v->rel ) {
+                    case relation::eq: return " == ";
+                    case relation::ne: return " != ";
+                    case relation::lt: return " < ";
+                    case relation::le: return " <= ";
+                    case relation::none: return "";
+                }
+                __builtin_unreachable();
+            } ();
+
+            if ( !rel.empty() )
+                res += " (" + print( v->lhs ) + rel + print( v->rhs ) + ")";
+            return res;
+        }
+
+        template< typename stream >
+        friend stream& operator<<( stream &os, zr v ) { return os << trace( v ); }
+    };
+
+} // namespace __lava
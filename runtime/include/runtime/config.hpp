@@ -30,6 +30,8 @@ namespace __lart::rt
         unsigned choose_bound = 0;
         bool choose_increasing = false;
 
+        unsigned widen_after = 3;
+
         bool error_found = false;
 
         bool no_fail_mode = false;
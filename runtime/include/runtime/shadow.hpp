@@ -39,4 +39,11 @@ namespace __lart::rt
     sc::generator< shadow_label_info > peek( const void *addr, size_t bytes );
 
     bool test_taint( void *addr, size_t bytes );
+
+    // number of active shadow frames
+    std::size_t frame_depth();
+
+    // called with the depth of a frame that is about to be destroyed
+    using frame_exit_hook_t = void (*)( std::size_t depth );
+    extern frame_exit_hook_t frame_exit_hook;
 }
@@ -55,6 +55,12 @@ namespace __lart::rt
             config->choose_bound = std::atoi( opt );
         }
 
+        config->widen_after = config_t().widen_after;
+        if ( auto opt = std::getenv( "LART_WIDEN_AFTER" ); opt ) {
+            fprintf( stderr, "[lart config] widen after = %s\n", opt );
+            config->widen_after = std::atoi( opt );
+        }
+
         if ( auto opt = std::getenv( "LART_TRACE_FILE" ); opt ) {
             fprintf( stderr, "[lart config] trace file = %s\n", opt );
             config->trace_file = std::fopen( opt, "w" );
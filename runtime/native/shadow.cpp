@@ -43,6 +43,10 @@ namespace __lart::rt
 
     frame_t& current_frame() { return frames.back(); }
 
+    std::size_t frame_depth() { return frames.size(); }
+
+    frame_exit_hook_t frame_exit_hook = nullptr;
+
 } // namespace __lart::rt
 
 extern "C" {
@@ -55,6 +59,9 @@ extern "C" {
 
     void __lart_exit_frame()
     {
+        if (__lart::rt::frame_exit_hook)
+            __lart::rt::frame_exit_hook(__lart::rt::frames.size());
+
         for (auto addr : __lart::rt::current_frame().addrs) {
             __lart::rt::shadow.erase(addr);
             __lart::rt::allocated.erase(addr);
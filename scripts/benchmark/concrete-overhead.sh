@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Measures the run-time overhead of instrumentation on a program whose
+# values may be abstract but stay concrete at run time, i.e., every
+# instrumented operation takes the concrete path of its taint test.
+# Each binary is run several times and the fastest run is reported.
+#
+# usage: concrete-overhead.sh [iterations] [domain] [optimization] [runs]
+
+set -e
+
+iterations=${1:-100000000}
+domain=${2:-interval}
+opt=${3:--O2}
+runs=${4:-5}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+source="$workdir/concrete.c"
+
+cat > $source <<SOURCE
+#ifdef NATIVE
+int __lamp_any_i32( void ) { return 0; }
+#else
+int __lamp_any_i32( void );
+#endif
+
+int main( int argc, char **argv ) {
+    // abstract only on a path that is never taken
+    int x = argc > 100 ? __lamp_any_i32() : argc;
+    int sum = 0;
+    for ( int i = 0; i < $iterations; ++i ) {
+        sum += ( x * i ) % 7 + i / ( x + 1 );
+        if ( sum > x * 1000 )
+            sum -= x;
+    }
+    return sum == 42;
+}
+SOURCE
+
+clang $opt -DNATIVE $source -o $workdir/native
+lartcc $domain $opt $source -o $workdir/abstracted
+
+# fastest of the runs in seconds
+best() {
+    TIMEFORMAT="%R"
+    for run in $(seq $runs); do
+        { time { $1 || true; } ; } 2>&1
+    done | sort -n | head -n 1
+}
+
+echo "native: $(best $workdir/native) s"
+echo "lartcc $domain: $(best $workdir/abstracted) s"
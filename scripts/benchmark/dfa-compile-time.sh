@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Measures compile time of lartcc on a generated module with many functions
+# that pass abstract values through arithmetic, memory and calls.
+#
+# usage: dfa-compile-time.sh [functions] [statements] [domain]
+
+set -e
+
+functions=${1:-2000}
+statements=${2:-100}
+domain=${3:-interval}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+source="$workdir/large.c"
+
+{
+    echo "int __lamp_any_i32( void );"
+    echo
+    for (( f = 0; f < functions; f++ )); do
+        echo "int fn$f( int x, int *p ) {"
+        echo "    int a = x, b = *p;"
+        for (( s = 0; s < statements; s++ )); do
+            case $(( s % 4 )) in
+                0) echo "    a = a + b * $s;" ;;
+                1) echo "    *p = a - $s;" ;;
+                2) echo "    b = *p < $s ? a : b;" ;;
+                3) echo "    if ( a > b ) a = b - 1;" ;;
+            esac
+        done
+        if (( f > 0 )); then
+            echo "    return fn$(( f - 1 ))( a, p ) + b;"
+        else
+            echo "    return a + b;"
+        fi
+        echo "}"
+        echo
+    done
+    echo "int main() {"
+    echo "    int v = __lamp_any_i32();"
+    echo "    return fn$(( functions - 1 ))( v, &v );"
+    echo "}"
+} > $source
+
+instructions=$(clang -S -emit-llvm -O0 $source -o - 2>/dev/null | grep -c '^  ' || true)
+echo "module: $functions functions, ~$instructions instructions"
+
+TIMEFORMAT="lartcc $domain: %R s"
+time {
+    SPDLOG_LEVEL=debug lartcc $domain $source -o $workdir/abstracted 2>&1 | grep "\[dfa\] propagation" || true
+}
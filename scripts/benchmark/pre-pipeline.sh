@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Compares shadow operations of a program abstracted as is and after the
+# pre-abstraction canonicalization (--lart-canonicalize), which promotes
+# locals to registers, so that their taint is propagated in registers
+# instead of shadow memory (freeze and melt of every load and store).
+#
+# usage: pre-pipeline.sh [iterations] [domain] [optimization]
+
+set -e
+
+iterations=${1:-10000000}
+domain=${2:-interval}
+opt=${3:--O0}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+source="$workdir/locals.c"
+
+cat > $source <<SOURCE
+int __lamp_any_i32( void );
+
+int main( int argc, char **argv ) {
+    // abstract only on a path that is never taken
+    int x = argc > 100 ? __lamp_any_i32() : argc;
+    int sum = 0;
+    for ( int i = 0; i < $iterations; ++i ) {
+        int t = x * i + 3;
+        sum += t % 7;
+        if ( sum > x * 1000 )
+            sum -= x;
+    }
+    return sum == 42;
+}
+SOURCE
+
+# shadow memory and argument stash operations left in the instrumented module
+shadow_ops() {
+    grep -cE "call .*@(__lamp_(freeze|melt)|__lart_(stash|unstash))" $1 || true
+}
+
+for mode in default canonicalize; do
+    flags=()
+    if [ "$mode" == "canonicalize" ]; then
+        flags=(--lart-canonicalize)
+    fi
+
+    lartcc $domain $opt "${flags[@]}" --lart-stats=$workdir/$mode.json -S -emit-llvm $source -o $workdir/$mode.ll 2> /dev/null
+    lartcc $domain $opt "${flags[@]}" $source -o $workdir/$mode
+
+    echo "$mode: $(shadow_ops $workdir/$mode.ll) static shadow operations"
+    grep -o '"counts":{[^}]*}' $workdir/$mode.json
+
+    TIMEFORMAT="$mode: %R s"
+    time { $workdir/$mode || true; }
+done
@@ -0,0 +1,23 @@
+// RUN: %testrun %lartcc bitvec-interval %s -o %t | %filecheck %s
+
+#include <lamp.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+int main() {
+    uint8_t x = __lamp_any_i8();
+
+    if ( x > 250 ) {
+        uint8_t y = x + 10; // wraps around to [5, 9]
+        if ( y > 9 ) {
+            UNREACHABLE
+        }
+        if ( y < 5 ) {
+            UNREACHABLE
+        }
+        REACHABLE
+    }
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,25 @@
+// RUN: %testrun %lartcc concolic -lz3 %s -o %t | %filecheck %s
+
+#include <lamp.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+int main() {
+    uint8_t x = __lamp_any_i8();
+    uint8_t y = __lamp_any_i8();
+
+    if ( x > 5 ) {
+        if ( x < 3 ) {
+            UNREACHABLE
+        }
+        if ( y == x ) {
+            if ( y + 1 < 7 ) {
+                UNREACHABLE
+            }
+            REACHABLE
+        }
+    }
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,20 @@
+// RUN: %testrun %lartcc float-interval %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    float x = __lamp_any_f32();
+
+    if ( x > 1.0f ) {
+        float y = x * 2.0f;
+        if ( y < 2.0f ) {
+            UNREACHABLE
+        }
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
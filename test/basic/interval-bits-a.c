@@ -0,0 +1,23 @@
+// RUN: %testrun %lartcc interval-bits %s -o %t | %filecheck %s
+
+#include <lamp.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+int main() {
+    uint8_t x = __lamp_any_i8();
+    uint8_t low = x & 0x0f;
+
+    if ( low > 15 ) {
+        UNREACHABLE
+    }
+
+    if ( ( low | 0x10 ) == 0 ) {
+        UNREACHABLE
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,19 @@
+// RUN: %testrun %lartcc interval-sign %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int x = __lamp_any_i32();
+
+    if ( x > 0 ) {
+        if ( x + 1 <= 0 ) {
+            UNREACHABLE
+        }
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
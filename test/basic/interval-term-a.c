@@ -0,0 +1,20 @@
+// RUN: %testrun %lartcc interval-term %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int x = __lamp_any_i32();
+    int y = 5 + 2;
+
+    if ( x < y ) {
+        if ( x > y ) {
+            UNREACHABLE
+        }
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,22 @@
+// RUN: %testrun %lartcc strided-interval %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int i = __lamp_any_i32();
+    int offset = 4 * i + 1;
+
+    if ( ( offset & 3 ) != 1 ) {
+        UNREACHABLE
+    }
+
+    if ( offset == 8 ) {
+        UNREACHABLE
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,25 @@
+// RUN: %testrun %lartcc term-portfolio -lz3 -lcvc5 -lpthread %s -o %t | %filecheck %s
+// REQUIRES: cvc5
+
+#include <lamp.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+int main() {
+    uint8_t x = __lamp_any_i8();
+    uint8_t y = __lamp_any_i8();
+
+    uint8_t sum = x + y;
+    if ( sum == 10 ) {
+        if ( x > 200 && y > 50 ) {
+            // the sum wraps around, e.g., x = 210 and y = 56
+            REACHABLE
+        }
+        if ( x * 2 == 7 ) {
+            UNREACHABLE
+        }
+    }
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
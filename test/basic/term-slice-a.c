@@ -0,0 +1,27 @@
+// RUN: %testrun %lartcc term -lz3 %s -o %t | %filecheck %s
+
+#include <lamp.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+int main() {
+    uint8_t x = __lamp_any_i8();
+    uint8_t y = __lamp_any_i8();
+    uint8_t z = __lamp_any_i8();
+
+    if ( y > 10 ) {
+        if ( x < 5 ) {
+            z = x;
+            if ( z > 7 ) {
+                UNREACHABLE
+            }
+            if ( y < 10 ) {
+                UNREACHABLE
+            }
+            REACHABLE
+        }
+    }
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
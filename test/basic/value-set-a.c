@@ -0,0 +1,24 @@
+// RUN: %testrun %lartcc value-set %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int x = __lamp_any_varg_i32( 3, 1, 100, 1000 );
+    int y = x * 10;
+
+    if ( y == 15 ) {
+        UNREACHABLE
+    }
+
+    if ( x > 1 && x < 100 ) {
+        UNREACHABLE
+    }
+
+    if ( x == 100 ) {
+        REACHABLE
+    }
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,20 @@
+// RUN: %testrun %lartcc interval %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int n = __lamp_any_i32();
+
+    int i;
+    for ( i = 0; i < n; ++i );
+
+    if ( i < 0 ) {
+        UNREACHABLE
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,22 @@
+// RUN: %testrun %lartcc interval %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int i = __lamp_any_i32();
+    int j = 0;
+
+    // i is stable right away, the path must not be cancelled before j is
+    while ( i < 100 ) {
+        ++i;
+        ++j;
+    }
+
+    if ( j == 10 ) {
+        REACHABLE
+    }
+
+    // CHECK: lart-reachable
+}
@@ -0,0 +1,21 @@
+// RUN: %testrun %lartcc zone %s -o %t | %filecheck %s
+
+#include <lamp.h>
+
+#include "utils.h"
+
+int main() {
+    int len = __lamp_any_i32();
+    int i = __lamp_any_i32();
+
+    if ( i < len ) {
+        int j = i + 1;
+        if ( j > len ) {
+            UNREACHABLE
+        }
+    }
+
+    REACHABLE
+    // CHECK-NOT: lart-unreachable
+    // CHECK: lart-reachable
+}